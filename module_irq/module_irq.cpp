@@ -0,0 +1,680 @@
+// module_irq.cpp --- 
+// 
+// Filename     : module_irq.cpp
+// Description  : Classes for waiting on and dispatching module interrupt lines.
+// Author       : Christophe Burki
+// Maintainer   : Christophe Burki
+// Created      : Sat Oct 17 10:04:37 2026
+// Version      : 1.0.0
+// Last-Updated : 
+//           By : 
+//     Update # : 0
+// URL          : 
+// Keywords     : 
+// Compatibility: 
+// 
+// 
+
+// Commentary   : 
+// 
+// 
+// 
+// 
+
+// Change log:
+// 
+// 
+// 
+// 
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 3 as
+// published by the Free Software Foundation.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program; see the file LICENSE.  If not, write to the
+// Free Software Foundation, Inc., 51 Franklin Street, Fifth
+// ;; Floor, Boston, MA 02110-1301, USA.
+// 
+// 
+
+// Code         :
+
+/* -------------------------------------------------------------------------- */
+
+#include <errno.h>
+#include <stdint.h>
+#include <sstream>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "module_irq.h"
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @~english
+ * @brief Create a source without file descriptor.
+ */
+gnublin_irq_source::gnublin_irq_source(void) {
+
+    fd = -1;
+    errorFlag = false;
+    edgeTime.tv_sec = 0;
+    edgeTime.tv_nsec = 0;
+}
+
+
+/**
+ * @~english
+ * @brief Close the file descriptor of the source.
+ */
+gnublin_irq_source::~gnublin_irq_source(void) {
+
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+
+/**
+ * @~english
+ * @brief Get the last error message.
+ *
+ * @return The error message as c-string.
+ */
+const char* gnublin_irq_source::getErrorMessage(void) {
+
+    return errorMessage.c_str();
+}
+
+
+/**
+ * @~english
+ * @brief Return whether the action fail or not.
+ *
+ * @return A boolean value indicating if the action fail or not.
+ */
+bool gnublin_irq_source::fail(void) {
+
+    return errorFlag;
+}
+
+
+/**
+ * @~english
+ * @brief Get the file descriptor to wait on.
+ *
+ * @return The file descriptor or -1 when the source could not be opened.
+ */
+int gnublin_irq_source::getFd(void) {
+
+    return fd;
+}
+
+
+/**
+ * @~english
+ * @brief Wait for an edge and acknowledge it.
+ *
+ * @param timeout The timeout in milliseconds, -1 to wait forever.
+ * @return -1 on error, 0 on timeout and 1 when an edge is detected.
+ */
+int gnublin_irq_source::wait(int timeout) {
+
+    errorFlag = false;
+    struct pollfd fdset;
+    int nfd;
+
+    if (fd < 0) {
+        errorFlag = true;
+        errorMessage = "IRQ source not opened\n";
+        return -1;
+    }
+
+    fdset.fd = fd;
+    fdset.events = getEvents();
+    fdset.revents = 0;
+
+    nfd = poll(&fdset, 1, timeout);
+    if (nfd < 0) {
+        errorFlag = true;
+        errorMessage = "poll Error\n";
+        return -1;
+    }
+
+    if (nfd == 0) {
+        return 0;
+    }
+
+    setEdgeTime();
+    if (ack() < 0) {
+        return -1;
+    }
+
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Record the time of the edge detected. It is called when the edge
+ * is detected, before acknowledging it.
+ */
+void gnublin_irq_source::setEdgeTime(void) {
+
+    clock_gettime(CLOCK_MONOTONIC, &edgeTime);
+}
+
+
+/**
+ * @~english
+ * @brief Get the time of the last edge detected.
+ *
+ * @param time The CLOCK_MONOTONIC time of the edge (0 when no edge was
+ * detected yet).
+ */
+void gnublin_irq_source::getEdgeTime(struct timespec *time) {
+
+    *time = edgeTime;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @~english
+ * @brief Configure the given GPIO as input with edge detection and open its
+ * value file.
+ *
+ * @param pin The GPIO connected to the IRQ line.
+ * @param edge The edge to detect (rising, falling or both).
+ */
+gnublin_irq_sysfs::gnublin_irq_sysfs(int pin, std::string edge) {
+
+    gnublin_gpio gpio;
+    std::ostringstream path;
+    int edgeFd;
+
+    gpio.pinMode(pin, INPUT);
+
+    path << "/sys/class/gpio/gpio" << pin << "/edge";
+    edgeFd = open(path.str().c_str(), O_WRONLY);
+    if (edgeFd < 0) {
+        errorFlag = true;
+        errorMessage = "open (" + path.str() + ") Error\n";
+        return;
+    }
+
+    if (write(edgeFd, edge.c_str(), edge.size()) < 0) {
+        errorFlag = true;
+        errorMessage = "write (" + path.str() + ") Error\n";
+        close(edgeFd);
+        return;
+    }
+    close(edgeFd);
+
+    path.str("");
+    path << "/sys/class/gpio/gpio" << pin << "/value";
+    fd = open(path.str().c_str(), O_RDONLY | O_NONBLOCK);
+    if (fd < 0) {
+        errorFlag = true;
+        errorMessage = "open (" + path.str() + ") Error\n";
+        return;
+    }
+
+    /* Clear the edge present at opening. */
+    ack();
+}
+
+
+/**
+ * @~english
+ * @brief Get the poll events signaling an edge.
+ *
+ * @return POLLPRI, the value file is always readable.
+ */
+short gnublin_irq_sysfs::getEvents(void) {
+
+    return POLLPRI;
+}
+
+
+/**
+ * @~english
+ * @brief Acknowledge an edge by reading the value file from its beginning.
+ *
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_irq_sysfs::ack(void) {
+
+    char value[4];
+
+    lseek(fd, 0, SEEK_SET);
+    if (read(fd, value, sizeof(value)) < 0) {
+        errorFlag = true;
+        errorMessage = "read (value) Error\n";
+        return -1;
+    }
+
+    return 1;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @~english
+ * @brief Create the eventfd.
+ */
+gnublin_irq_eventfd::gnublin_irq_eventfd(void) {
+
+    fd = eventfd(0, EFD_NONBLOCK);
+    if (fd < 0) {
+        errorFlag = true;
+        errorMessage = "eventfd Error\n";
+    }
+}
+
+
+/**
+ * @~english
+ * @brief Get the poll events signaling an edge.
+ *
+ * @return POLLIN.
+ */
+short gnublin_irq_eventfd::getEvents(void) {
+
+    return POLLIN;
+}
+
+
+/**
+ * @~english
+ * @brief Acknowledge the edges by reading the eventfd counter.
+ *
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_irq_eventfd::ack(void) {
+
+    uint64_t value;
+
+    if ((read(fd, &value, sizeof(value)) < 0) && (errno != EAGAIN)) {
+        errorFlag = true;
+        errorMessage = "read (eventfd) Error\n";
+        return -1;
+    }
+
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Generate an edge.
+ *
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_irq_eventfd::trigger(void) {
+
+    uint64_t value = 1;
+
+    errorFlag = false;
+    if (write(fd, &value, sizeof(value)) < 0) {
+        errorFlag = true;
+        errorMessage = "write (eventfd) Error\n";
+        return -1;
+    }
+
+    return 1;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @~english
+ * @brief Create the epoll instance of the reactor.
+ */
+gnublin_irq_reactor::gnublin_irq_reactor(void) {
+
+    struct epoll_event event;
+
+    errorFlag = false;
+    running = false;
+    count = 0;
+
+    epollFd = epoll_create1(0);
+    wakeupFd = eventfd(0, EFD_NONBLOCK);
+    if ((epollFd < 0) || (wakeupFd < 0)) {
+        errorFlag = true;
+        errorMessage = "epoll_create1/eventfd Error\n";
+        return;
+    }
+
+    /* The wakeup eventfd is used to stop the reactor. */
+    event.events = EPOLLIN;
+    event.data.ptr = NULL;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeupFd, &event) < 0) {
+        errorFlag = true;
+        errorMessage = "epoll_ctl (wakeup) Error\n";
+    }
+}
+
+
+/**
+ * @~english
+ * @brief Close the epoll instance. The sources are not closed.
+ */
+gnublin_irq_reactor::~gnublin_irq_reactor(void) {
+
+    if (epollFd >= 0) {
+        close(epollFd);
+    }
+
+    if (wakeupFd >= 0) {
+        close(wakeupFd);
+    }
+}
+
+
+/**
+ * @~english
+ * @brief Get the last error message.
+ *
+ * @return The error message as c-string.
+ */
+const char* gnublin_irq_reactor::getErrorMessage(void) {
+
+    return errorMessage.c_str();
+}
+
+
+/**
+ * @~english
+ * @brief Return whether the action fail or not.
+ *
+ * @return A boolean value indicating if the action fail or not.
+ */
+bool gnublin_irq_reactor::fail(void) {
+
+    return errorFlag;
+}
+
+
+/**
+ * @~english
+ * @brief Register a handler for the given source. The source is given to
+ * the handler (setIrqSource). Several handlers could be registered for the
+ * same source. The pending interrupts of the handler are serviced, their
+ * edge could have been missed otherwise.
+ *
+ * @param handler The handler to register.
+ * @param source The source of the handler interrupts.
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_irq_reactor::add(gnublin_irq_handler *handler, gnublin_irq_source *source) {
+
+    errorFlag = false;
+    bool registered = false;
+    struct epoll_event event;
+
+    if (count == IRQ_MAX_HANDLERS) {
+        errorFlag = true;
+        errorMessage = "Too many handlers\n";
+        return -1;
+    }
+
+    if (source->getFd() < 0) {
+        errorFlag = true;
+        errorMessage = "IRQ source not opened\n";
+        return -1;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (sources[i] == source) {
+            registered = true;
+        }
+    }
+
+    if (!registered) {
+        event.events = (source->getEvents() & POLLPRI) ? EPOLLPRI : EPOLLIN;
+        event.data.ptr = source;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, source->getFd(), &event) < 0) {
+            errorFlag = true;
+            errorMessage = "epoll_ctl (add) Error\n";
+            return -1;
+        }
+    }
+
+    handlers[count] = handler;
+    sources[count] = source;
+    busy[count] = false;
+    count++;
+    handler->setIrqSource(source);
+
+    return service(count - 1);
+}
+
+
+/**
+ * @~english
+ * @brief Unregister a handler.
+ *
+ * @param handler The handler to unregister.
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_irq_reactor::remove(gnublin_irq_handler *handler) {
+
+    errorFlag = false;
+    gnublin_irq_source *source = NULL;
+
+    for (int i = 0; i < count; i++) {
+        if (handlers[i] == handler) {
+            source = sources[i];
+            count--;
+            handlers[i] = handlers[count];
+            sources[i] = sources[count];
+            busy[i] = busy[count];
+            break;
+        }
+    }
+
+    if (source == NULL) {
+        errorFlag = true;
+        errorMessage = "Handler not registered\n";
+        return -1;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (sources[i] == source) {
+            /* The source is still used by another handler. */
+            return 1;
+        }
+    }
+
+    if (epoll_ctl(epollFd, EPOLL_CTL_DEL, source->getFd(), NULL) < 0) {
+        errorFlag = true;
+        errorMessage = "epoll_ctl (del) Error\n";
+        return -1;
+    }
+
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Wait for edges and dispatch them to the handlers. The handlers
+ * asking to be polled (see gnublin_irq_handler::getPollTimeout) and the
+ * handlers still busy (see service) are serviced after the edges, the wait
+ * is shortened to their poll timeout and is not done for the busy ones.
+ *
+ * @param timeout The timeout in milliseconds, -1 to wait forever.
+ * @return -1 on error or the number of sources with an edge (0 on timeout).
+ */
+int gnublin_irq_reactor::wait(int timeout) {
+
+    errorFlag = false;
+    struct epoll_event events[IRQ_MAX_HANDLERS + 1];
+    int nfd;
+
+    for (int i = 0; i < count; i++) {
+        int pollTimeout = handlers[i]->getPollTimeout();
+        if (busy[i]) {
+            pollTimeout = 0;
+        }
+        if ((pollTimeout >= 0) && ((timeout < 0) || (pollTimeout < timeout))) {
+            timeout = pollTimeout;
+        }
+    }
+
+    nfd = epoll_wait(epollFd, events, IRQ_MAX_HANDLERS + 1, timeout);
+    if (nfd < 0) {
+        if (errno == EINTR) {
+            return 0;
+        }
+
+        errorFlag = true;
+        errorMessage = "epoll_wait Error\n";
+        return -1;
+    }
+
+    for (int i = 0; i < nfd; i++) {
+        gnublin_irq_source *source = (gnublin_irq_source *)events[i].data.ptr;
+
+        if (source == NULL) {
+            uint64_t value;
+            if (read(wakeupFd, &value, sizeof(value)) < 0) {
+                /* Nothing to do, the counter is already cleared. */
+            }
+            running = false;
+            continue;
+        }
+
+        if (dispatch(source) < 0) {
+            return -1;
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (busy[i] || (handlers[i]->getPollTimeout() >= 0)) {
+            if (service(i) < 0) {
+                return -1;
+            }
+        }
+    }
+
+    return nfd;
+}
+
+
+/**
+ * @~english
+ * @brief Wait for edges and dispatch them until stop is called.
+ *
+ * @return -1 on error and 1 when stopped.
+ */
+int gnublin_irq_reactor::run(void) {
+
+    running = true;
+    while (running) {
+        if (wait(-1) < 0) {
+            running = false;
+            return -1;
+        }
+    }
+
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Stop the reactor. It could be called from a handler or from
+ * another thread.
+ *
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_irq_reactor::stop(void) {
+
+    uint64_t value = 1;
+
+    if (write(wakeupFd, &value, sizeof(value)) < 0) {
+        errorFlag = true;
+        errorMessage = "write (wakeup) Error\n";
+        return -1;
+    }
+
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Call the pollInt of the given handler until no interrupt is
+ * pending anymore. The IRQ line is released once all the interrupts have
+ * been serviced, no edge would be detected otherwise. After IRQ_MAX_SERVICE
+ * calls the handler is marked busy, it is serviced again by the next wait
+ * without waiting for an edge.
+ *
+ * @param index The index of the handler to service.
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_irq_reactor::service(int index) {
+
+    busy[index] = true;
+
+    for (int i = 0; i < IRQ_MAX_SERVICE; i++) {
+        int ret = handlers[index]->pollInt();
+
+        if (ret < 0) {
+            errorFlag = true;
+            errorMessage = "pollInt Error\n";
+            return -1;
+        }
+
+        if (ret == 0) {
+            busy[index] = false;
+            break;
+        }
+    }
+
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Acknowledge the edge of the given source and service all the
+ * handlers registered for this source.
+ *
+ * @param source The source with an edge.
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_irq_reactor::dispatch(gnublin_irq_source *source) {
+
+    source->setEdgeTime();
+    if (source->ack() < 0) {
+        errorFlag = true;
+        errorMessage = source->getErrorMessage();
+        return -1;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (sources[i] == source) {
+            if (service(i) < 0) {
+                return -1;
+            }
+        }
+    }
+
+    return 1;
+}
+
+/* -------------------------------------------------------------------------- */
+
+// 
+// module_irq.cpp ends here
@@ -0,0 +1,205 @@
+/* module_irq.h --- 
+ * 
+ * Filename     : module_irq.h
+ * Description  : Classes for waiting on and dispatching module interrupt lines.
+ * Author       : Christophe Burki
+ * Maintainer   : Christophe Burki
+ * Created      : Sat Oct 17 10:02:11 2026
+ * Version      : 1.0.0
+ * Last-Updated : 
+ *           By : 
+ *     Update # : 0
+ * URL          : 
+ * Keywords     : 
+ * Compatibility: 
+ * 
+ */
+
+/* Commentary   : 
+ *
+ * The interrupt line (IRQ) of a module is connected to a GPIO of the board.
+ * An edge on the GPIO is detected with poll/epoll on the value file of the
+ * GPIO (/sys/class/gpio/gpioN/value). The source of the edges is abstracted
+ * by gnublin_irq_source so that an eventfd could be used in place of the
+ * GPIO for testing without hardware.
+ *
+ * The modules servicing interrupts (pollInt) implement gnublin_irq_handler.
+ * The reactor (gnublin_irq_reactor) owns the file descriptors of the
+ * sources and wait for edges with epoll. On an edge, it calls the pollInt
+ * of the handlers registered for the source until no interrupt is pending
+ * anymore, so that the IRQ line is released and the next edge is detected.
+ * A handler still busy after IRQ_MAX_SERVICE calls is serviced again by
+ * the next wait without waiting for an edge, the other sources are not
+ * starved. Several handlers could share the same source (wired-OR IRQ
+ * lines).
+ *
+ * A handler could ask to be polled without edges (getPollTimeout), for
+ * instance while it mitigates the interrupts of a burst. The reactor then
+ * wakes up at least every poll timeout and calls its pollInt.
+ *
+ */
+
+/* Change log:
+ * 
+ * 
+ */
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as 
+ * published by the Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file LICENSE.  If not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth
+ * ;; Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* Code         : */
+
+#ifndef GNUBLIN_MODULE_IRQ
+#define GNUBLIN_MODULE_IRQ
+
+/* -------------------------------------------------------------------------- */
+
+#include <poll.h>
+#include <time.h>
+
+#include "gnublin.h"
+
+/* -------------------------------------------------------------------------- */
+
+#define IRQ_EDGE_RISING  "rising"
+#define IRQ_EDGE_FALLING "falling"
+#define IRQ_EDGE_BOTH    "both"
+
+#define IRQ_MAX_HANDLERS 16  /* Maximum number of handlers in a reactor. */
+#define IRQ_MAX_SERVICE  8   /* Maximum number of pollInt calls per edge. */
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @class gnublin_irq_source
+ * @~english
+ * @brief Source of interrupt edges that could be waited for with poll/epoll.
+ */
+class gnublin_irq_source {
+
+ protected :
+    int fd;
+    bool errorFlag;
+    std::string errorMessage;
+    struct timespec edgeTime;  /* CLOCK_MONOTONIC time of the last edge detected. */
+
+ public :
+    gnublin_irq_source(void);
+    virtual ~gnublin_irq_source(void);
+    const char* getErrorMessage(void);
+    bool fail(void);
+    int getFd(void);
+    virtual short getEvents(void) = 0;
+    virtual int ack(void) = 0;
+    virtual int wait(int timeout);
+    void setEdgeTime(void);
+    void getEdgeTime(struct timespec *time);
+};
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @class gnublin_irq_sysfs
+ * @~english
+ * @brief Interrupt edges from a GPIO using the sysfs interface.
+ */
+class gnublin_irq_sysfs : public gnublin_irq_source {
+
+ public :
+    gnublin_irq_sysfs(int pin, std::string edge = IRQ_EDGE_FALLING);
+    short getEvents(void);
+    int ack(void);
+};
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @class gnublin_irq_eventfd
+ * @~english
+ * @brief Interrupt edges from an eventfd. The edges are generated by calling
+ * trigger. This is a stand-in for a GPIO when testing without hardware.
+ */
+class gnublin_irq_eventfd : public gnublin_irq_source {
+
+ public :
+    gnublin_irq_eventfd(void);
+    short getEvents(void);
+    int ack(void);
+    int trigger(void);
+};
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @class gnublin_irq_handler
+ * @~english
+ * @brief Interface of the modules servicing interrupts.
+ */
+class gnublin_irq_handler {
+
+ protected :
+    gnublin_irq_source *irqSource;
+
+ public :
+    gnublin_irq_handler(void) : irqSource(NULL) {}
+    virtual ~gnublin_irq_handler(void) {}
+    virtual int pollInt(void) = 0;
+    virtual int getPollTimeout(void) { return -1; }
+    void setIrqSource(gnublin_irq_source *source) { irqSource = source; }
+    gnublin_irq_source *getIrqSource(void) { return irqSource; }
+};
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @class gnublin_irq_reactor
+ * @~english
+ * @brief Wait for interrupt edges with epoll and dispatch them to the
+ * handlers.
+ */
+class gnublin_irq_reactor {
+
+ protected :
+    int epollFd;
+    int wakeupFd;
+    bool errorFlag;
+    std::string errorMessage;
+    bool running;
+
+    int count;
+    gnublin_irq_handler *handlers[IRQ_MAX_HANDLERS];
+    gnublin_irq_source *sources[IRQ_MAX_HANDLERS];
+    bool busy[IRQ_MAX_HANDLERS];  /* Still pending after IRQ_MAX_SERVICE pollInt calls. */
+
+    int service(int index);
+    int dispatch(gnublin_irq_source *source);
+
+ public :
+    gnublin_irq_reactor(void);
+    virtual ~gnublin_irq_reactor(void);
+    const char* getErrorMessage(void);
+    bool fail(void);
+    int add(gnublin_irq_handler *handler, gnublin_irq_source *source);
+    int remove(gnublin_irq_handler *handler);
+    int wait(int timeout = -1);
+    int run(void);
+    int stop(void);
+};
+
+/* -------------------------------------------------------------------------- */
+
+#endif
+
+/* module_irq.h ends here */
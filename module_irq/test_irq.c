@@ -0,0 +1,146 @@
+/* test_irq.c --- 
+ * 
+ * Filename     : test_irq.c
+ * Description  : Test the IRQ reactor with an eventfd source.
+ * Author       : Christophe Burki
+ * Maintainer   : Christophe Burki
+ * Created      : Sat Oct 17 10:15:48 2026
+ * Version      : 1.0.0
+ * Last-Updated : 
+ *           By : 
+ *     Update # : 0
+ * URL          : 
+ * Keywords     : 
+ * Compatibility: 
+ * 
+ */
+
+/* Commentary   : 
+ * 
+ * 
+ * 
+ */
+
+/* Change log:
+ * 
+ * 
+ */
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as 
+ * published by the Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file LICENSE.  If not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth
+ * ;; Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* Code         : */
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+#include <stdio.h>
+
+#include "module_irq.h"
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Handler simulating a device with a number of pending interrupts.
+ */
+class test_handler : public gnublin_irq_handler {
+
+ public :
+    const char *name;
+    int pending;
+    int pollTimeout;
+
+    test_handler(const char *name) : name(name), pending(0), pollTimeout(-1) {}
+
+    int getPollTimeout(void) {
+
+        return pollTimeout;
+    }
+
+    int pollInt(void) {
+
+        if (pending == 0) {
+            return 0;
+        }
+
+        printf("%s : interrupt serviced (%d pending)\n", name, pending);
+        pending--;
+        return 1;
+    }
+};
+
+/* -------------------------------------------------------------------------- */
+
+int main(void) {
+
+    gnublin_irq_eventfd irq1;
+    gnublin_irq_eventfd irq2;
+    gnublin_irq_reactor reactor;
+    test_handler handler1("handler1");
+    test_handler handler2("handler2");
+    test_handler handler3("handler3");
+
+    if (irq1.fail() || irq2.fail() || reactor.fail()) {
+        printf("init Error\n");
+        return -1;
+    }
+
+    /* Two handlers are sharing the same IRQ line. */
+    reactor.add(&handler1, &irq1);
+    reactor.add(&handler2, &irq1);
+    reactor.add(&handler3, &irq2);
+
+    handler1.pending = 2;
+    handler2.pending = 1;
+    irq1.trigger();
+    printf("wait : %d\n", reactor.wait(100));
+
+    handler3.pending = 3;
+    irq2.trigger();
+    printf("wait : %d\n", reactor.wait(100));
+
+    /* Timeout. */
+    printf("wait : %d\n", reactor.wait(100));
+
+    reactor.remove(&handler2);
+    handler1.pending = 1;
+    handler2.pending = 1;
+    irq1.trigger();
+    printf("wait : %d (handler2 pending %d)\n", reactor.wait(100), handler2.pending);
+
+    /* Polled without edge. */
+    handler3.pending = 2;
+    handler3.pollTimeout = 10;
+    int ret = reactor.wait(1000);
+    printf("wait : %d (handler3 pending %d)\n", ret, handler3.pending);
+    handler3.pollTimeout = -1;
+
+    /* Still busy after IRQ_MAX_SERVICE calls, serviced again without edge. */
+    handler1.pending = 2 * IRQ_MAX_SERVICE + 4;
+    irq1.trigger();
+    ret = reactor.wait(100);
+    printf("wait : %d (handler1 pending %d)\n", ret, handler1.pending);
+    ret = reactor.wait(10);
+    printf("wait : %d (handler1 pending %d)\n", ret, handler1.pending);
+
+    reactor.stop();
+    printf("run : %d\n", reactor.run());
+
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* test_irq.c ends here */
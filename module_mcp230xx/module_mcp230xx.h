@@ -49,6 +49,7 @@
 /* -------------------------------------------------------------------------- */
 
 #include "gnublin.h"
+#include "module_irq.h"
 
 /* -------------------------------------------------------------------------- */
 
@@ -71,7 +72,7 @@
  * @~english
  * @brief Class for accessing the MCP23017 and MCP23009 port expander via I2C.
  */
-class gnublin_module_mcp230xx {
+class gnublin_module_mcp230xx : public gnublin_irq_handler {
 
   protected :
     gnublin_i2c i2c;
@@ -0,0 +1,728 @@
+// module_modbus.cpp --- 
+// 
+// Filename     : module_modbus.cpp
+// Description  : Modbus RTU master over a SC16IS7x0 UART.
+// Author       : Christophe Burki
+// Maintainer   : Christophe Burki
+// Created      : Sat Oct 17 18:14:05 2026
+// Version      : 1.0.0
+// Last-Updated : 
+//           By : 
+//     Update # : 0
+// URL          : 
+// Keywords     : 
+// Compatibility: 
+// 
+// 
+
+// Commentary   : 
+// 
+// 
+// 
+// 
+
+// Change log:
+// 
+// 
+// 
+// 
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 3 as
+// published by the Free Software Foundation.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program; see the file LICENSE.  If not, write to the
+// Free Software Foundation, Inc., 51 Franklin Street, Fifth
+// ;; Floor, Boston, MA 02110-1301, USA.
+// 
+// 
+
+// Code         :
+
+/* -------------------------------------------------------------------------- */
+
+#include <string.h>
+#include <sys/uio.h>
+
+#include "module_modbus.h"
+
+/* -------------------------------------------------------------------------- */
+
+/* CRC-16 of the Modbus RTU frames (polynomial 0xA001 reflected). */
+static const unsigned short crcTable[256] = {
+    0x0000, 0xc0c1, 0xc181, 0x0140, 0xc301, 0x03c0, 0x0280, 0xc241,
+    0xc601, 0x06c0, 0x0780, 0xc741, 0x0500, 0xc5c1, 0xc481, 0x0440,
+    0xcc01, 0x0cc0, 0x0d80, 0xcd41, 0x0f00, 0xcfc1, 0xce81, 0x0e40,
+    0x0a00, 0xcac1, 0xcb81, 0x0b40, 0xc901, 0x09c0, 0x0880, 0xc841,
+    0xd801, 0x18c0, 0x1980, 0xd941, 0x1b00, 0xdbc1, 0xda81, 0x1a40,
+    0x1e00, 0xdec1, 0xdf81, 0x1f40, 0xdd01, 0x1dc0, 0x1c80, 0xdc41,
+    0x1400, 0xd4c1, 0xd581, 0x1540, 0xd701, 0x17c0, 0x1680, 0xd641,
+    0xd201, 0x12c0, 0x1380, 0xd341, 0x1100, 0xd1c1, 0xd081, 0x1040,
+    0xf001, 0x30c0, 0x3180, 0xf141, 0x3300, 0xf3c1, 0xf281, 0x3240,
+    0x3600, 0xf6c1, 0xf781, 0x3740, 0xf501, 0x35c0, 0x3480, 0xf441,
+    0x3c00, 0xfcc1, 0xfd81, 0x3d40, 0xff01, 0x3fc0, 0x3e80, 0xfe41,
+    0xfa01, 0x3ac0, 0x3b80, 0xfb41, 0x3900, 0xf9c1, 0xf881, 0x3840,
+    0x2800, 0xe8c1, 0xe981, 0x2940, 0xeb01, 0x2bc0, 0x2a80, 0xea41,
+    0xee01, 0x2ec0, 0x2f80, 0xef41, 0x2d00, 0xedc1, 0xec81, 0x2c40,
+    0xe401, 0x24c0, 0x2580, 0xe541, 0x2700, 0xe7c1, 0xe681, 0x2640,
+    0x2200, 0xe2c1, 0xe381, 0x2340, 0xe101, 0x21c0, 0x2080, 0xe041,
+    0xa001, 0x60c0, 0x6180, 0xa141, 0x6300, 0xa3c1, 0xa281, 0x6240,
+    0x6600, 0xa6c1, 0xa781, 0x6740, 0xa501, 0x65c0, 0x6480, 0xa441,
+    0x6c00, 0xacc1, 0xad81, 0x6d40, 0xaf01, 0x6fc0, 0x6e80, 0xae41,
+    0xaa01, 0x6ac0, 0x6b80, 0xab41, 0x6900, 0xa9c1, 0xa881, 0x6840,
+    0x7800, 0xb8c1, 0xb981, 0x7940, 0xbb01, 0x7bc0, 0x7a80, 0xba41,
+    0xbe01, 0x7ec0, 0x7f80, 0xbf41, 0x7d00, 0xbdc1, 0xbc81, 0x7c40,
+    0xb401, 0x74c0, 0x7580, 0xb541, 0x7700, 0xb7c1, 0xb681, 0x7640,
+    0x7200, 0xb2c1, 0xb381, 0x7340, 0xb101, 0x71c0, 0x7080, 0xb041,
+    0x5000, 0x90c1, 0x9181, 0x5140, 0x9301, 0x53c0, 0x5280, 0x9241,
+    0x9601, 0x56c0, 0x5780, 0x9741, 0x5500, 0x95c1, 0x9481, 0x5440,
+    0x9c01, 0x5cc0, 0x5d80, 0x9d41, 0x5f00, 0x9fc1, 0x9e81, 0x5e40,
+    0x5a00, 0x9ac1, 0x9b81, 0x5b40, 0x9901, 0x59c0, 0x5880, 0x9841,
+    0x8801, 0x48c0, 0x4980, 0x8941, 0x4b00, 0x8bc1, 0x8a81, 0x4a40,
+    0x4e00, 0x8ec1, 0x8f81, 0x4f40, 0x8d01, 0x4dc0, 0x4c80, 0x8c41,
+    0x4400, 0x84c1, 0x8581, 0x4540, 0x8701, 0x47c0, 0x4680, 0x8641,
+    0x8201, 0x42c0, 0x4380, 0x8341, 0x4100, 0x81c1, 0x8081, 0x4040
+};
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @~english
+ * @brief Return the time elapsed from the given time to the given end in
+ * microseconds.
+ */
+static long elapsedUs(const struct timespec *from, const struct timespec *to) {
+
+    return (to->tv_sec - from->tv_sec) * 1000000L + (to->tv_nsec - from->tv_nsec) / 1000;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @~english
+ * @brief Initialize an empty transaction.
+ */
+modbus_transaction::modbus_transaction(void) {
+
+    slave = 0;
+    requestLen = 0;
+    responseLen = 0;
+    status = MODBUS_PENDING;
+    exception = 0;
+    latency = 0;
+    sent.tv_sec = 0;
+    sent.tv_nsec = 0;
+    callback = NULL;
+    context = NULL;
+}
+
+
+/**
+ * @~english
+ * @brief Set the request of the transaction.
+ *
+ * @param slave The slave address (0 for broadcast).
+ * @param function The function code.
+ * @param data The data of the request.
+ * @param len The length of the data.
+ * @return -1 on error and 1 on success.
+ */
+int modbus_transaction::setRequest(unsigned char slave, unsigned char function, const unsigned char *data, unsigned int len) {
+
+    if (len + 1 > MODBUS_MAX_PDU) {
+        return -1;
+    }
+
+    this->slave = slave;
+    request[0] = function;
+    if (len > 0) {
+        memcpy(request + 1, data, len);
+    }
+    requestLen = len + 1;
+    responseLen = 0;
+    status = MODBUS_PENDING;
+    exception = 0;
+
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Set a read holding registers request (function 0x03).
+ *
+ * @param slave The slave address.
+ * @param address The address of the first register.
+ * @param count The number of registers (1 to 125).
+ * @return -1 on error and 1 on success.
+ */
+int modbus_transaction::readHoldingRegisters(unsigned char slave, unsigned short address, unsigned short count) {
+
+    unsigned char data[4] = {(unsigned char)(address >> 8), (unsigned char)address, (unsigned char)(count >> 8), (unsigned char)count};
+
+    if ((count == 0) || (count > 125)) {
+        return -1;
+    }
+
+    return setRequest(slave, MODBUS_READ_HOLDING_REGISTERS, data, sizeof(data));
+}
+
+
+/**
+ * @~english
+ * @brief Set a read input registers request (function 0x04).
+ *
+ * @param slave The slave address.
+ * @param address The address of the first register.
+ * @param count The number of registers (1 to 125).
+ * @return -1 on error and 1 on success.
+ */
+int modbus_transaction::readInputRegisters(unsigned char slave, unsigned short address, unsigned short count) {
+
+    unsigned char data[4] = {(unsigned char)(address >> 8), (unsigned char)address, (unsigned char)(count >> 8), (unsigned char)count};
+
+    if ((count == 0) || (count > 125)) {
+        return -1;
+    }
+
+    return setRequest(slave, MODBUS_READ_INPUT_REGISTERS, data, sizeof(data));
+}
+
+
+/**
+ * @~english
+ * @brief Set a write single register request (function 0x06).
+ *
+ * @param slave The slave address.
+ * @param address The address of the register.
+ * @param value The value to write.
+ * @return -1 on error and 1 on success.
+ */
+int modbus_transaction::writeSingleRegister(unsigned char slave, unsigned short address, unsigned short value) {
+
+    unsigned char data[4] = {(unsigned char)(address >> 8), (unsigned char)address, (unsigned char)(value >> 8), (unsigned char)value};
+
+    return setRequest(slave, MODBUS_WRITE_SINGLE_REGISTER, data, sizeof(data));
+}
+
+
+/**
+ * @~english
+ * @brief Set a write multiple registers request (function 0x10).
+ *
+ * @param slave The slave address.
+ * @param address The address of the first register.
+ * @param values The values to write.
+ * @param count The number of registers (1 to 123).
+ * @return -1 on error and 1 on success.
+ */
+int modbus_transaction::writeMultipleRegisters(unsigned char slave, unsigned short address, const unsigned short *values, unsigned short count) {
+
+    unsigned char data[5 + 2 * 123];
+
+    if ((count == 0) || (count > 123)) {
+        return -1;
+    }
+
+    data[0] = address >> 8;
+    data[1] = address & 0xff;
+    data[2] = count >> 8;
+    data[3] = count & 0xff;
+    data[4] = count * 2;
+    for (unsigned int i = 0; i < count; i++) {
+        data[5 + 2 * i] = values[i] >> 8;
+        data[6 + 2 * i] = values[i] & 0xff;
+    }
+
+    return setRequest(slave, MODBUS_WRITE_MULTIPLE_REGISTERS, data, 5 + 2 * count);
+}
+
+
+/**
+ * @~english
+ * @brief Get the registers of a read registers response.
+ *
+ * @param values The registers read.
+ * @param count The size of values in registers.
+ * @return -1 when the response is not a read registers response and the
+ * number of registers on success.
+ */
+int modbus_transaction::getRegisters(unsigned short *values, unsigned int count) {
+
+    if ((status != MODBUS_DONE) || (responseLen < 2) ||
+        ((response[0] != MODBUS_READ_HOLDING_REGISTERS) && (response[0] != MODBUS_READ_INPUT_REGISTERS))) {
+        return -1;
+    }
+
+    unsigned int registers = response[1] / 2;
+    if (responseLen < 2 + 2 * registers) {
+        return -1;
+    }
+
+    if (registers > count) {
+        registers = count;
+    }
+    for (unsigned int i = 0; i < registers; i++) {
+        values[i] = (response[2 + 2 * i] << 8) | response[3 + 2 * i];
+    }
+
+    return registers;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @~english
+ * @brief Initialize the master.
+ */
+gnublin_module_modbus::gnublin_module_modbus(void) {
+
+    errorFlag = false;
+    uart = NULL;
+    timeout = MODBUS_DEFAULT_TIMEOUT;
+
+    queueHead = 0;
+    queueCount = 0;
+    current = NULL;
+    deadline.tv_sec = 0;
+    deadline.tv_nsec = 0;
+
+    frameLen = 0;
+    frameOverflow = 0;
+
+    requests = 0;
+    responses = 0;
+    timeouts = 0;
+    crcErrors = 0;
+    frameErrors = 0;
+}
+
+
+/**
+ * @~english
+ * @brief Get the last error message.
+ *
+ * @return The error message as c-string.
+ */
+const char* gnublin_module_modbus::getErrorMessage(void) {
+
+    return errorMessage.c_str();
+}
+
+
+/**
+ * @~english
+ * @brief Return whether the action fail or not.
+ *
+ * @return A boolean value indicating if the action fail or not.
+ */
+bool gnublin_module_modbus::fail(void) {
+
+    return errorFlag;
+}
+
+
+/**
+ * @~english
+ * @brief Attach the master to the given UART. The UART is put in framing
+ * mode, the data received is accumulated from its data received ISR and
+ * the frame is checked on its RX timeout ISR. The RX FIFO and the RHR
+ * interrupt must be enabled by the caller.
+ *
+ * @param uart The UART.
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_module_modbus::attach(gnublin_module_sc16is7x0 *uart) {
+
+    errorFlag = false;
+
+    if (uart == NULL) {
+        errorFlag = true;
+        errorMessage = "UART is NULL\n";
+        return -1;
+    }
+
+    this->uart = uart;
+    uart->intIsrDataReceived(&dataReceived, this);
+    uart->intIsrRxTimeout(&rxTimeout, this);
+    if (uart->enableRxFraming(1) < 0) {
+        errorFlag = true;
+        errorMessage = uart->getErrorMessage();
+        return -1;
+    }
+
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Set the response timeout. It is counted from the end of the
+ * request (estimated from the baud rate).
+ *
+ * @param timeout The timeout in ms.
+ */
+void gnublin_module_modbus::setTimeout(int timeout) {
+
+    this->timeout = timeout;
+}
+
+
+/**
+ * @~english
+ * @brief Queue a transaction. The request is sent at once when the link is
+ * idle, otherwise when the previous transactions are completed. The
+ * callback of the transaction is called on completion.
+ *
+ * @param transaction The transaction, it must stay valid until completed.
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_module_modbus::submit(modbus_transaction *transaction) {
+
+    errorFlag = false;
+
+    if (uart == NULL) {
+        errorFlag = true;
+        errorMessage = "No UART attached\n";
+        return -1;
+    }
+
+    if ((transaction == NULL) || (transaction->requestLen == 0)) {
+        errorFlag = true;
+        errorMessage = "Transaction has no request\n";
+        return -1;
+    }
+
+    if (queueCount == MODBUS_MAX_QUEUE) {
+        errorFlag = true;
+        errorMessage = "Transaction queue is full\n";
+        return -1;
+    }
+
+    transaction->status = MODBUS_PENDING;
+    transaction->responseLen = 0;
+    queue[(queueHead + queueCount) % MODBUS_MAX_QUEUE] = transaction;
+    queueCount++;
+
+    if (current == NULL) {
+        return start();
+    }
+
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Check the response timeout and start the queued requests. It must
+ * be called periodically, for example after each wait of the reactor.
+ *
+ * @return -1 on error and the number of transactions pending on success.
+ */
+int gnublin_module_modbus::process(void) {
+
+    errorFlag = false;
+    struct timespec now;
+
+    if (current != NULL) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (elapsedUs(&deadline, &now) >= 0) {
+            timeouts++;
+            if (complete(MODBUS_TIMEOUT) < 0) {
+                return -1;
+            }
+        }
+    }
+    else if (queueCount > 0) {
+        if (start() < 0) {
+            return -1;
+        }
+    }
+
+    return pending();
+}
+
+
+/**
+ * @~english
+ * @brief Get the number of transactions queued or waiting for their
+ * response.
+ *
+ * @return The number of transactions.
+ */
+int gnublin_module_modbus::pending(void) {
+
+    return queueCount + (current != NULL ? 1 : 0);
+}
+
+
+/**
+ * @~english
+ * @brief Send the request of the next queued transaction. The broadcast
+ * requests are completed as soon as sent. The request is left in the queue
+ * while the TX ring buffer of the UART has no room for the whole frame, it
+ * is sent by a next call to process.
+ *
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_module_modbus::start(void) {
+
+    while ((current == NULL) && (queueCount > 0)) {
+        modbus_transaction *transaction = queue[queueHead];
+        int frameSize = 1 + transaction->requestLen + 2;
+
+        /* A partial request must not be queued for the line. */
+        if (TX_BUFFER_SIZE - uart->txBufferedData() < frameSize) {
+            return 1;
+        }
+
+        queueHead = (queueHead + 1) % MODBUS_MAX_QUEUE;
+        queueCount--;
+
+        unsigned short crc = crc16(transaction->request, transaction->requestLen, crc16(&transaction->slave, 1));
+        unsigned char trailer[2] = {(unsigned char)(crc & 0xff), (unsigned char)(crc >> 8)};
+
+        struct iovec iov[3];
+        iov[0].iov_base = &transaction->slave;
+        iov[0].iov_len = 1;
+        iov[1].iov_base = transaction->request;
+        iov[1].iov_len = transaction->requestLen;
+        iov[2].iov_base = trailer;
+        iov[2].iov_len = sizeof(trailer);
+
+        /* Discard what is left of a late response. */
+        frameLen = 0;
+        frameOverflow = 0;
+        current = transaction;
+
+        int written = uart->writev(iov, 3);
+        if (written != frameSize) {
+            errorFlag = true;
+            errorMessage = (written < 0) ? uart->getErrorMessage() : "Request not completely written\n";
+            complete(MODBUS_FRAME_ERROR);
+            return -1;
+        }
+        requests++;
+
+        clock_gettime(CLOCK_MONOTONIC, &transaction->sent);
+        if (transaction->slave == MODBUS_BROADCAST) {
+            complete(MODBUS_DONE);
+            continue;
+        }
+
+        /* The timeout starts when the request is on the line, 11 bits per
+           character. */
+        long us = (long)timeout * 1000;
+        unsigned int baud = uart->getBaudRate();
+        if (baud > 0) {
+            us += (long)(transaction->requestLen + 3) * 11 * 1000000L / baud;
+        }
+        deadline = transaction->sent;
+        deadline.tv_sec += us / 1000000;
+        deadline.tv_nsec += (us % 1000000) * 1000;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+    }
+
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Complete the current transaction and send the next request.
+ *
+ * @param status The status of the transaction.
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_module_modbus::complete(int status) {
+
+    modbus_transaction *transaction = current;
+    struct timespec now;
+
+    current = NULL;
+    frameLen = 0;
+    frameOverflow = 0;
+
+    if (transaction != NULL) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        transaction->latency = elapsedUs(&transaction->sent, &now);
+        transaction->status = status;
+        if (transaction->callback != NULL) {
+            transaction->callback(transaction, transaction->context);
+        }
+    }
+
+    return start();
+}
+
+
+/**
+ * @~english
+ * @brief Check the frame received and complete the current transaction
+ * with it. The frames received while no response is expected are
+ * discarded.
+ */
+void gnublin_module_modbus::frameEnd(void) {
+
+    if ((current == NULL) || (frameLen == 0)) {
+        frameLen = 0;
+        return;
+    }
+
+    if (frameOverflow || (frameLen < 4)) {
+        frameErrors++;
+        complete(MODBUS_FRAME_ERROR);
+        return;
+    }
+
+    if (crc16(frame, frameLen) != 0) {
+        /* The CRC of a frame including its CRC is 0. */
+        crcErrors++;
+        complete(MODBUS_CRC_ERROR);
+        return;
+    }
+
+    unsigned char function = frame[1];
+    if ((frame[0] != current->slave) || ((function & ~MODBUS_EXCEPTION_FLAG) != current->request[0])) {
+        frameErrors++;
+        complete(MODBUS_FRAME_ERROR);
+        return;
+    }
+
+    responses++;
+    current->responseLen = frameLen - 3;
+    memcpy(current->response, frame + 1, current->responseLen);
+
+    if (function & MODBUS_EXCEPTION_FLAG) {
+        current->exception = frame[2];
+        complete(MODBUS_EXCEPTION);
+        return;
+    }
+
+    complete(MODBUS_DONE);
+}
+
+
+/**
+ * @~english
+ * @brief Data received ISR of the UART, accumulate the bytes of the frame.
+ */
+void gnublin_module_modbus::dataReceived(const char *buffer, int len, void *context) {
+
+    gnublin_module_modbus *master = (gnublin_module_modbus *)context;
+
+    if (master->frameLen + len > MODBUS_MAX_ADU) {
+        master->frameOverflow = 1;
+        len = MODBUS_MAX_ADU - master->frameLen;
+    }
+    memcpy(master->frame + master->frameLen, buffer, len);
+    master->frameLen += len;
+}
+
+
+/**
+ * @~english
+ * @brief RX timeout ISR of the UART, the line is silent : the frame is
+ * complete.
+ */
+void gnublin_module_modbus::rxTimeout(void *context) {
+
+    gnublin_module_modbus *master = (gnublin_module_modbus *)context;
+
+    master->frameEnd();
+}
+
+
+/**
+ * @~english
+ * @brief Compute the CRC-16 of a RTU frame.
+ *
+ * @param data The data (address, function and data).
+ * @param len The length of the data.
+ * @param crc The CRC of the previous data, to compute it in several parts.
+ * @return The CRC, its LSB is sent first.
+ */
+unsigned short gnublin_module_modbus::crc16(const unsigned char *data, unsigned int len, unsigned short crc) {
+
+    for (unsigned int i = 0; i < len; i++) {
+        crc = (crc >> 8) ^ crcTable[(crc ^ data[i]) & 0xff];
+    }
+
+    return crc;
+}
+
+
+/**
+ * @~english
+ * @brief Get the number of requests sent.
+ *
+ * @return The number of requests.
+ */
+unsigned long gnublin_module_modbus::getRequests(void) {
+
+    return requests;
+}
+
+
+/**
+ * @~english
+ * @brief Get the number of valid responses received (exceptions included).
+ *
+ * @return The number of responses.
+ */
+unsigned long gnublin_module_modbus::getResponses(void) {
+
+    return responses;
+}
+
+
+/**
+ * @~english
+ * @brief Get the number of transactions without response before the
+ * timeout.
+ *
+ * @return The number of timeouts.
+ */
+unsigned long gnublin_module_modbus::getTimeouts(void) {
+
+    return timeouts;
+}
+
+
+/**
+ * @~english
+ * @brief Get the number of responses received with a wrong CRC.
+ *
+ * @return The number of responses.
+ */
+unsigned long gnublin_module_modbus::getCrcErrors(void) {
+
+    return crcErrors;
+}
+
+
+/**
+ * @~english
+ * @brief Get the number of responses too short, too long or not matching
+ * the request.
+ *
+ * @return The number of responses.
+ */
+unsigned long gnublin_module_modbus::getFrameErrors(void) {
+
+    return frameErrors;
+}
+
+/* -------------------------------------------------------------------------- */
+
+// 
+// module_modbus.cpp ends here
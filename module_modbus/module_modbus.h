@@ -0,0 +1,194 @@
+/* module_modbus.h --- 
+ * 
+ * Filename     : module_modbus.h
+ * Description  : Modbus RTU master over a SC16IS7x0 UART.
+ * Author       : Christophe Burki
+ * Maintainer   : Christophe Burki
+ * Created      : Sat Oct 17 18:12:33 2026
+ * Version      : 1.0.0
+ * Last-Updated : 
+ *           By : 
+ *     Update # : 0
+ * URL          : 
+ * Keywords     : 
+ * Compatibility: 
+ * 
+ */
+
+/* Commentary   : 
+ *
+ * Modbus RTU frame
+ *
+ * | Slave address | Function | Data ... | CRC LSB | CRC MSB |
+ *
+ * The frames are separated by a silence of at least 3.5 character times.
+ * The CRC is the CRC-16 (polynomial 0xA001 reflected, initial value
+ * 0xFFFF) of the address, the function and the data, computed with a
+ * lookup table.
+ *
+ * The end of a response is not detected with host timers. The UART is put
+ * in framing mode (see enableRxFraming) : a byte is kept in the RX FIFO on
+ * RHR interrupts so that the RX timeout interrupt of the chip (4 character
+ * times of silence) is raised at the end of each frame. The bytes received
+ * are accumulated from the data received ISR and the frame is checked on
+ * the RX timeout ISR.
+ *
+ * A master drives one link (one UART). Its transactions are queued and
+ * sent one at a time, the next request is sent from the ISR as soon as the
+ * response is received. The links are independent, the masters of
+ * several UARTs serviced by the same reactor have their requests
+ * outstanding at the same time. Only the response timeout uses the host
+ * clock, it is checked by process.
+ *
+ */
+
+/* Change log:
+ * 
+ * 
+ */
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as 
+ * published by the Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file LICENSE.  If not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth
+ * ;; Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* Code         : */
+
+#ifndef GNUBLIN_MODULE_MODBUS
+#define GNUBLIN_MODULE_MODBUS
+
+/* -------------------------------------------------------------------------- */
+
+#include "gnublin.h"
+#include "module_sc16is7x0.h"
+
+/* -------------------------------------------------------------------------- */
+
+#define MODBUS_MAX_ADU          256  /* Maximum length of a RTU frame (address, PDU and CRC). */
+#define MODBUS_MAX_PDU          253  /* Maximum length of the PDU (function and data). */
+#define MODBUS_MAX_QUEUE        16   /* Maximum number of transactions queued per master. */
+#define MODBUS_DEFAULT_TIMEOUT  100  /* Response timeout in ms. */
+#define MODBUS_BROADCAST        0    /* Broadcast address, no response. */
+
+/* Function codes. */
+#define MODBUS_READ_COILS               0x01
+#define MODBUS_READ_DISCRETE_INPUTS     0x02
+#define MODBUS_READ_HOLDING_REGISTERS   0x03
+#define MODBUS_READ_INPUT_REGISTERS     0x04
+#define MODBUS_WRITE_SINGLE_COIL        0x05
+#define MODBUS_WRITE_SINGLE_REGISTER    0x06
+#define MODBUS_WRITE_MULTIPLE_REGISTERS 0x10
+#define MODBUS_EXCEPTION_FLAG           0x80  /* Set in the function code of the exception responses. */
+
+/* Status of a transaction. */
+#define MODBUS_PENDING     0  /* Queued or waiting for the response. */
+#define MODBUS_DONE        1  /* Response received. */
+#define MODBUS_EXCEPTION   2  /* Exception response received (see exception). */
+#define MODBUS_TIMEOUT     3  /* No response before the timeout. */
+#define MODBUS_CRC_ERROR   4  /* Response with a bad CRC. */
+#define MODBUS_FRAME_ERROR 5  /* Response from another slave, for another function or too short. */
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @class modbus_transaction
+ * @~english
+ * @brief A request and its response. The transaction is owned by the
+ * caller, it must stay valid until completed.
+ */
+class modbus_transaction {
+
+ public :
+    unsigned char slave;
+    unsigned char request[MODBUS_MAX_PDU];   /* Function and data. */
+    unsigned int requestLen;
+    unsigned char response[MODBUS_MAX_PDU];  /* Function and data. */
+    unsigned int responseLen;
+    int status;
+    unsigned char exception;                 /* Exception code when status is MODBUS_EXCEPTION. */
+    unsigned long latency;                   /* Time from the request sent to the response in us. */
+    struct timespec sent;
+
+    void (*callback)(modbus_transaction *, void *);
+    void *context;
+
+    modbus_transaction(void);
+    int setRequest(unsigned char slave, unsigned char function, const unsigned char *data, unsigned int len);
+    int readHoldingRegisters(unsigned char slave, unsigned short address, unsigned short count);
+    int readInputRegisters(unsigned char slave, unsigned short address, unsigned short count);
+    int writeSingleRegister(unsigned char slave, unsigned short address, unsigned short value);
+    int writeMultipleRegisters(unsigned char slave, unsigned short address, const unsigned short *values, unsigned short count);
+    int getRegisters(unsigned short *values, unsigned int count);
+};
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @class gnublin_module_modbus
+ * @~english
+ * @brief Modbus RTU master driving a link over a SC16IS7x0 UART. The frames
+ * are delimited by the RX timeout interrupt of the chip.
+ */
+class gnublin_module_modbus {
+
+ protected :
+    bool errorFlag;
+    std::string errorMessage;
+
+    gnublin_module_sc16is7x0 *uart;
+    int timeout;
+
+    modbus_transaction *queue[MODBUS_MAX_QUEUE];
+    unsigned int queueHead;
+    unsigned int queueCount;
+    modbus_transaction *current;  /* Transaction waiting for its response. */
+    struct timespec deadline;     /* Response timeout of the current transaction. */
+
+    unsigned char frame[MODBUS_MAX_ADU];
+    unsigned int frameLen;
+    int frameOverflow;
+
+    unsigned long requests;
+    unsigned long responses;
+    unsigned long timeouts;
+    unsigned long crcErrors;
+    unsigned long frameErrors;
+
+    int start(void);
+    int complete(int status);
+    void frameEnd(void);
+    static void dataReceived(const char *buffer, int len, void *context);
+    static void rxTimeout(void *context);
+
+ public :
+    gnublin_module_modbus(void);
+    const char* getErrorMessage(void);
+    bool fail(void);
+    int attach(gnublin_module_sc16is7x0 *uart);
+    void setTimeout(int timeout);
+    int submit(modbus_transaction *transaction);
+    int process(void);
+    int pending(void);
+    static unsigned short crc16(const unsigned char *data, unsigned int len, unsigned short crc = 0xffff);
+    unsigned long getRequests(void);
+    unsigned long getResponses(void);
+    unsigned long getTimeouts(void);
+    unsigned long getCrcErrors(void);
+    unsigned long getFrameErrors(void);
+};
+
+/* -------------------------------------------------------------------------- */
+
+#endif
+
+/* module_modbus.h ends here */
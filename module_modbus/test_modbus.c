@@ -0,0 +1,284 @@
+/* test_modbus.c --- 
+ * 
+ * Filename     : test_modbus.c
+ * Description  : Test the Modbus RTU master with simulated slaves.
+ * Author       : Christophe Burki
+ * Maintainer   : Christophe Burki
+ * Created      : Sat Oct 17 18:31:47 2026
+ * Version      : 1.0.0
+ * Last-Updated : 
+ *           By : 
+ *     Update # : 0
+ * URL          : 
+ * Keywords     : 
+ * Compatibility: 
+ * 
+ */
+
+/* Commentary   : 
+ * 
+ * 
+ * 
+ */
+
+/* Change log:
+ * 
+ * 
+ */
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as 
+ * published by the Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file LICENSE.  If not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth
+ * ;; Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* Code         : */
+/* -------------------------------------------------------------------------- */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "gnublin.h"
+#include "module_sc16is750.h"
+#include "module_modbus.h"
+
+/* -------------------------------------------------------------------------- */
+
+int failures = 0;
+
+void check(const char *name, int condition) {
+
+    printf("%s : %s\n", condition ? "PASS" : "FAIL", name);
+    if (!condition) {
+        failures++;
+    }
+}
+
+
+int completed = 0;
+
+void onComplete(modbus_transaction *transaction, void *context) {
+    printf("onComplete(slave=%d, status=%d, latency=%luus)\n", transaction->slave, transaction->status, transaction->latency);
+    completed++;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Registers of the simulated slaves. */
+unsigned short registers[16];
+
+
+/**
+ * Drain the request sent to the simulated slave and inject its response.
+ * The response CRC is corrupted when asked.
+ *
+ * @return The length of the request drained.
+ */
+int respond(sc16is7x0_transport_mock *mock, int corrupt) {
+
+    unsigned char request[MODBUS_MAX_ADU];
+    unsigned char response[MODBUS_MAX_ADU];
+    unsigned int len = 0;
+    int requestLen = mock->drain((char *)request, sizeof(request));
+
+    if ((requestLen < 4) || (gnublin_module_modbus::crc16(request, requestLen) != 0)) {
+        return requestLen;
+    }
+
+    unsigned short address = (request[2] << 8) | request[3];
+    unsigned short count = (request[4] << 8) | request[5];
+    response[len++] = request[0];
+    response[len++] = request[1];
+
+    switch (request[1]) {
+    case MODBUS_READ_HOLDING_REGISTERS :
+        if (address + count > 16) {
+            response[1] |= MODBUS_EXCEPTION_FLAG;
+            response[len++] = 0x02;
+            break;
+        }
+        response[len++] = count * 2;
+        for (unsigned int i = 0; i < count; i++) {
+            response[len++] = registers[address + i] >> 8;
+            response[len++] = registers[address + i] & 0xff;
+        }
+        break;
+    case MODBUS_WRITE_SINGLE_REGISTER :
+        registers[address] = count;
+        memcpy(response + len, request + 2, 4);
+        len += 4;
+        break;
+    default :
+        response[1] |= MODBUS_EXCEPTION_FLAG;
+        response[len++] = 0x01;
+        break;
+    }
+
+    unsigned short crc = gnublin_module_modbus::crc16(response, len);
+    response[len++] = crc & 0xff;
+    response[len++] = (crc >> 8) ^ (corrupt ? 0x01 : 0x00);
+    mock->inject((const char *)response, len);
+
+    return requestLen;
+}
+
+
+/**
+ * Service the interrupts of the UART until none is pending.
+ */
+void service(gnublin_module_sc16is750 *uart, sc16is7x0_transport_mock *mock) {
+
+    while (mock->isIntPending()) {
+        uart->pollInt();
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+int main(void) {
+    printf("Testing the Modbus RTU master.\n");
+
+    /* CRC of the read holding registers example of the specification. */
+    const unsigned char example[] = {0x11, 0x03, 0x00, 0x6b, 0x00, 0x03};
+    check("crc16", gnublin_module_modbus::crc16(example, sizeof(example)) == 0x8776);
+
+    for (int i = 0; i < 16; i++) {
+        registers[i] = 0x1000 + i;
+    }
+
+    /* Two links, each with its own master. */
+    sc16is7x0_transport_mock mock1;
+    sc16is7x0_transport_mock mock2;
+    gnublin_module_sc16is750 uart1;
+    gnublin_module_sc16is750 uart2;
+    gnublin_module_modbus master1;
+    gnublin_module_modbus master2;
+
+    uart1.setTransport(&mock1);
+    uart2.setTransport(&mock2);
+    gnublin_module_sc16is750 *uarts[2] = {&uart1, &uart2};
+    for (int i = 0; i < 2; i++) {
+        uarts[i]->init();
+        uarts[i]->enableFifo(1);
+        uarts[i]->rxFifoSetTriggerLevel(8);
+        uarts[i]->setInterrupt(CONF_INT_RHREN);
+    }
+    check("attach", (master1.attach(&uart1) == 1) && (master2.attach(&uart2) == 1));
+
+    /* One request outstanding on each link at the same time. */
+    modbus_transaction read1;
+    modbus_transaction read2;
+    read1.readHoldingRegisters(1, 2, 3);
+    read2.readHoldingRegisters(2, 0, 4);
+    read1.callback = &onComplete;
+    read2.callback = &onComplete;
+    check("submit", (master1.submit(&read1) == 1) && (master2.submit(&read2) == 1));
+    check("pending", (master1.pending() == 1) && (master2.pending() == 1));
+    check("requests sent", (respond(&mock1, 0) == 8) && (respond(&mock2, 0) == 8));
+    service(&uart1, &mock1);
+    service(&uart2, &mock2);
+
+    unsigned short values[4];
+    check("response 1", (read1.status == MODBUS_DONE) && (read1.getRegisters(values, 4) == 3) && (values[0] == 0x1002) && (values[2] == 0x1004));
+    check("response 2", (read2.status == MODBUS_DONE) && (read2.getRegisters(values, 4) == 4) && (values[3] == 0x1003));
+    check("callbacks", completed == 2);
+
+    /* Response of 21 bytes, received in several RHR interrupts. */
+    modbus_transaction read8;
+    read8.readHoldingRegisters(1, 0, 8);
+    master1.submit(&read8);
+    respond(&mock1, 0);
+    service(&uart1, &mock1);
+    check("response 8 registers", (read8.status == MODBUS_DONE) && (read8.getRegisters(values, 4) == 4));
+
+    /* Response of 9 bytes, one above the trigger level. */
+    modbus_transaction read2r;
+    read2r.readHoldingRegisters(1, 0, 2);
+    master1.submit(&read2r);
+    respond(&mock1, 0);
+    service(&uart1, &mock1);
+    check("response 2 registers", read2r.status == MODBUS_DONE);
+
+    /* Queued transactions are sent one after the other. The response to
+       the write (8 bytes) is exactly the trigger level, the RX timeout still
+       ends it. */
+    modbus_transaction write;
+    modbus_transaction readBack;
+    write.writeSingleRegister(1, 5, 0xbeef);
+    readBack.readHoldingRegisters(1, 5, 1);
+    master1.submit(&write);
+    master1.submit(&readBack);
+    check("queued", master1.pending() == 2);
+    check("write sent alone", respond(&mock1, 0) == 8);
+    service(&uart1, &mock1);
+    check("write done", (write.status == MODBUS_DONE) && (registers[5] == 0xbeef));
+    check("read sent on response", respond(&mock1, 0) == 8);
+    service(&uart1, &mock1);
+    check("read back", (readBack.getRegisters(values, 1) == 1) && (values[0] == 0xbeef));
+
+    /* Exception, CRC error and timeout. */
+    modbus_transaction bad;
+    bad.readHoldingRegisters(1, 15, 4);
+    master1.submit(&bad);
+    respond(&mock1, 0);
+    service(&uart1, &mock1);
+    check("exception", (bad.status == MODBUS_EXCEPTION) && (bad.exception == 0x02));
+
+    modbus_transaction corrupted;
+    corrupted.readHoldingRegisters(1, 0, 1);
+    master1.submit(&corrupted);
+    respond(&mock1, 1);
+    service(&uart1, &mock1);
+    check("crc error", (corrupted.status == MODBUS_CRC_ERROR) && (master1.getCrcErrors() == 1));
+
+    modbus_transaction lost;
+    lost.readHoldingRegisters(3, 0, 1);
+    master2.setTimeout(10);
+    master2.submit(&lost);
+    char dropped[MODBUS_MAX_ADU];
+    check("request lost", mock2.drain(dropped, sizeof(dropped)) == 8);
+    check("waiting", master2.process() == 1);
+    usleep(50000);
+    check("timeout", (master2.process() == 0) && (lost.status == MODBUS_TIMEOUT) && (master2.getTimeouts() == 1));
+
+    /* The request waits for room in the TX ring buffer, it is not sent in
+       part. */
+    char filler[TX_BUFFER_SIZE];
+    memset(filler, 0, sizeof(filler));
+    uart2.enableTxBuffer(1);
+    uart2.write(filler, sizeof(filler));
+    uart2.write(filler, TX_BUFFER_SIZE - uart2.txBufferedData() - 4);
+    modbus_transaction deferred;
+    deferred.readHoldingRegisters(2, 0, 1);
+    check("deferred", (master2.submit(&deferred) == 1) && (master2.pending() == 1) && (uart2.txBufferedData() == TX_BUFFER_SIZE - 4));
+    while (uart2.txBufferedData() > 0) {
+        mock2.drain(dropped, sizeof(dropped));
+        uart2.pollInt();
+    }
+    mock2.drain(dropped, sizeof(dropped));
+    check("deferred sent", (master2.process() == 1) && (respond(&mock2, 0) == 8));
+    service(&uart2, &mock2);
+    check("deferred done", deferred.status == MODBUS_DONE);
+    uart2.enableTxBuffer(0);
+
+    /* Broadcast, no response expected. */
+    modbus_transaction broadcast;
+    broadcast.writeSingleRegister(MODBUS_BROADCAST, 6, 0x1234);
+    check("broadcast", (master2.submit(&broadcast) == 1) && (broadcast.status == MODBUS_DONE) && (master2.pending() == 0));
+
+    printf("%d failure(s)\n", failures);
+    return failures;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* test_modbus.c ends here */
@@ -104,9 +104,9 @@ int gnublin_module_sc16is750::initIO(unsigned char value) {
      * IOCTRL[7] : Reserved
      */
     txValue = CONF_IO_DEFAULT | value;
-    if (i2c.send(IOCTRL, &txValue, 1) < 0) {
+    if (transport->send(IOCTRL, &txValue, 1) < 0) {
         errorFlag = true;
-        errorMessage = "i2c.send (IOCTRL) Error\n";
+        errorMessage = "send (IOCTRL) Error\n";
         return -1;
     }
 
@@ -144,7 +144,7 @@ int gnublin_module_sc16is750::pinMode(int pin, std::string direction) {
     txValue = 1 << pin;
 
     /* Read the current state. */
-    if (i2c.receive(IODIR, &rxValue, 1) > 0) {
+    if (transport->receive(IODIR, &rxValue, 1) > 0) {
 
         if (direction == OUTPUT) {
             txValue = rxValue | txValue;
@@ -158,19 +158,19 @@ int gnublin_module_sc16is750::pinMode(int pin, std::string direction) {
             return -1;
         }
 
-        if (i2c.send(IODIR, &txValue, 1) > 0) {
+        if (transport->send(IODIR, &txValue, 1) > 0) {
             return 1;
         }
         else {
             errorFlag = true;
-            errorMessage = "i2c.send (IODIR) Error\n";
+            errorMessage = "send (IODIR) Error\n";
             return -1;
         }
     }
 
     else {
         errorFlag = true;
-        errorMessage = "i2c.receive (IODIR) Error\n";
+        errorMessage = "receive (IODIR) Error\n";
         return -1;
     }
 
@@ -205,12 +205,12 @@ int gnublin_module_sc16is750::portMode(std::string direction) {
         return -1;
     }
 
-    if (i2c.send(IODIR, &txValue, 1) > 0) {
+    if (transport->send(IODIR, &txValue, 1) > 0) {
         return 1;
     }
     else {
         errorFlag = true;
-        errorMessage = "i2c.send (IODIR) Error\n";
+        errorMessage = "send (IODIR) Error\n";
         return -1;
     }
 
@@ -243,7 +243,7 @@ int gnublin_module_sc16is750::digitalWrite(int pin, int value) {
     txValue = 1 << pin;
 
     /* Read the current state. */
-    if (i2c.receive(IOSTATE, &rxValue, 1) > 0) {
+    if (transport->receive(IOSTATE, &rxValue, 1) > 0) {
             
         if (value == 0) {
             txValue = rxValue & ~txValue;
@@ -257,19 +257,19 @@ int gnublin_module_sc16is750::digitalWrite(int pin, int value) {
             return -1;
         }
         
-        if (i2c.send(IOSTATE, &txValue, 1) > 0) {
+        if (transport->send(IOSTATE, &txValue, 1) > 0) {
             return 1;
         }
         else {
             errorFlag = true;
-            errorMessage = "i2c.send (IOSTATE) Error\n";
+            errorMessage = "send (IOSTATE) Error\n";
             return -1;
         }
     }
     
     else {
         errorFlag = true;
-        errorMessage = "i2c.receive (IOSTATE) Error\n";
+        errorMessage = "receive (IOSTATE) Error\n";
         return -1;
     }
 
@@ -297,7 +297,7 @@ int gnublin_module_sc16is750::digitalRead(int pin) {
         return -1;
     }
 
-    if (i2c.receive(IOSTATE, &rxValue, 1) > 0) {
+    if (transport->receive(IOSTATE, &rxValue, 1) > 0) {
         rxValue <<= (7 - pin);  /* MSB is now the pin we want to read from. */
         rxValue &= 128;         /* Set all bits to 0 except the MSB. */
 
@@ -315,7 +315,7 @@ int gnublin_module_sc16is750::digitalRead(int pin) {
     }
     else {
         errorFlag = true;
-        errorMessage = "i2c.receive (IOSTATE) Error\n";
+        errorMessage = "receive (IOSTATE) Error\n";
         return -1;
     }
 
@@ -351,12 +351,12 @@ int gnublin_module_sc16is750::writePort(unsigned char value) {
     unsigned char txValue;
     txValue = value;
 
-    if (i2c.send(IOSTATE, &txValue, 1) > 0) {
+    if (transport->send(IOSTATE, &txValue, 1) > 0) {
         return 1;
     }
     else {
         errorFlag = true;
-        errorMessage = "i2c.send (IOSTATE) Error\n";
+        errorMessage = "send (IOSTATE) Error\n";
         return -1;
     }
 
@@ -377,12 +377,12 @@ unsigned char gnublin_module_sc16is750::readPort() {
     errorFlag = false;
     unsigned char rxValue;
 
-    if (i2c.receive(IOSTATE, &rxValue, 1) > 0) {
+    if (transport->receive(IOSTATE, &rxValue, 1) > 0) {
         return rxValue;
     }
     else {
         errorFlag = true;
-        errorMessage = "i2c.receive (IOSTATE) Error";
+        errorMessage = "receive (IOSTATE) Error";
         return -1;
     }
 
@@ -415,7 +415,7 @@ int gnublin_module_sc16is750::pinIntEnable(int pin, int value) {
     txValue = 1 << pin;
 
     /* Read the current state. */
-    if (i2c.receive(IOINTEN, &rxValue, 1) > 0) {
+    if (transport->receive(IOINTEN, &rxValue, 1) > 0) {
             
         if (value == 0) {
             txValue = rxValue & ~txValue;
@@ -429,7 +429,7 @@ int gnublin_module_sc16is750::pinIntEnable(int pin, int value) {
             return -1;
         }
         
-        if (i2c.send(IOINTEN, &txValue, 1) > 0) {
+        if (transport->send(IOINTEN, &txValue, 1) > 0) {
 
             /* Store the IOSTATE value fro the pin. */
             int pinState = digitalRead(pin);
@@ -447,14 +447,14 @@ int gnublin_module_sc16is750::pinIntEnable(int pin, int value) {
         }
         else {
             errorFlag = true;
-            errorMessage = "i2c.send (IOINTEN) Error\n";
+            errorMessage = "send (IOINTEN) Error\n";
             return -1;
         }
     }
     
     else {
         errorFlag = true;
-        errorMessage = "i2c.receive (IOINTEN) Error\n";
+        errorMessage = "receive (IOINTEN) Error\n";
         return -1;
     }
 
@@ -488,7 +488,7 @@ int gnublin_module_sc16is750::portIntEnable(int value) {
         return -1;
     }
 
-    if (i2c.send(IOINTEN, &txValue, 1) > 0) {
+    if (transport->send(IOINTEN, &txValue, 1) > 0) {
 
         /* Store the IOSTATE value fro the pin. */
         ioLatchReg = readPort();
@@ -501,7 +501,7 @@ int gnublin_module_sc16is750::portIntEnable(int value) {
     }
     else {
         errorFlag = true;
-        errorMessage = "i2c.send (IOINTEN) Error\n";
+        errorMessage = "send (IOINTEN) Error\n";
         return -1;
     }
 
@@ -531,15 +531,15 @@ unsigned char gnublin_module_sc16is750::readIntFlagPort(void) {
         return -1;
     }
 
-    if (i2c.receive(IODIR, &ioDir, 1) < 0) {
+    if (transport->receive(IODIR, &ioDir, 1) < 0) {
         errorFlag = true;
-        errorMessage = "i2c.receive (IODIR) Error\n";
+        errorMessage = "receive (IODIR) Error\n";
         return -1;
     }
     
-    if (i2c.receive(IOINTEN, &intEn, 1) < 0) {
+    if (transport->receive(IOINTEN, &intEn, 1) < 0) {
         errorFlag = true;
-        errorMessage = "i2c.receive (IOITNEN) Error\n";
+        errorMessage = "receive (IOITNEN) Error\n";
         return -1;
     }
 
@@ -553,93 +553,47 @@ unsigned char gnublin_module_sc16is750::readIntFlagPort(void) {
 
 /**
  * @~english
- * @brief Poll for an interrupt. It call the appropriate ISR callbacks when
- * an interrupt occurs.
+ * @brief Service the given interrupt. It call the appropriate ISR callbacks.
+ * The UART interrupts are serviced by gnublin_module_sc16is7x0.
  *
+ * @param interrupt The pending interrupt (see whichInt).
  * @return The number of interrupts or -1 on error.
  */
-int gnublin_module_sc16is750::pollInt(void) {
-
-    errorFlag = false;
+int gnublin_module_sc16is750::serviceInt(int interrupt) {
 
     int count = 0;
-    int interrupt = whichInt();
     unsigned char intFlags;
 
-    if (interrupt == 0) {
-        /* No pending interrupt. */
-        return interrupt;
-    }
-    if (interrupt < 0) {
-        /* Error while identifying interrupt. */
-        return interrupt;
-    }
-    //printf("sc16is750::interrupt=0x%02x\n", interrupt);
-
-    switch (interrupt) {
-    case INT_RLSE :  /* Receiver line status error. */
-        //break;
-    case INT_RTOUT :  /* Receiver timeout. */
-        //break;
-    case INT_RHR :  /* RHR. */
-        if (isrDataReceived != NULL) {
-            int available = rxAvailableData();
-            if (available > 0) {
-                char *buffer = (char *)malloc(available + 1);
-                read(buffer, available);
-                buffer[available] = '\0';
-                
-                isrDataReceived(buffer, available + 1);
+    if (interrupt != INT_PINS) {
+        return gnublin_module_sc16is7x0::serviceInt(interrupt);
+    }
+
+    /* Input pin change. */
+    intFlags = readIntFlagPort();
+    //printf("intFlags=0x%02x\n", (unsigned int)intFlags);
+
+    for (int pin = 0; pin < 8; pin++) {
+        if (intFlags & (1 << pin)) {
+
+            /* The value of the pin has changed. */
+            int value = ioLatchReg << (7 - pin);
+            value &= 128;
+            if (value == 128) {
+                value = 1;
             }
-        }
-        count++;
-        break;
-    case INT_THR :  /* THR. */
-        if (isrSpaceAvailable != NULL) {
-            int available = txAvailableSpace();
-            isrSpaceAvailable(available);
-        }
-        count++;
-        break;
-    case INT_MODEM :  /* Modem. */
-        break;
-    case INT_PINS :  /* Input pin change. */
-        intFlags = readIntFlagPort();
-        //printf("intFlags=0x%02x\n", (unsigned int)intFlags);
-
-        for (int pin = 0; pin < 8; pin++) {
-            if (intFlags & (1 << pin)) {
-
-                /* The value of the pin has changed. */
-                int value = ioLatchReg << (7 - pin);
-                value &= 128;
-                if (value == 128) {
-                    value = 1;
-                }
-                
-                if (isrIO != NULL) {
-                    isrIO(pin, value);
-                }
-                
-                count++;
+
+            if (isrIO != NULL) {
+                isrIO(pin, value);
             }
-        }
 
-        /* Store the IO values in case they have changed before the interrupts
-           have been treated. */
-        ioLatchReg = readPort();
-        break;
-    case INT_XOFF :  /* Received Xoff signal / special character. */
-        break;
-    case INT_CTSRTS :  /* CTS, RTS change of state from active (LOW) to inactive (HIGH). */
-        break;
-    default :
-        errorFlag = true;
-        errorMessage = "Unknown interrupt source\n";
-        return -1;
-        break;
+            count++;
+        }
     }
 
+    /* Store the IO values in case they have changed before the interrupts
+       have been treated. */
+    ioLatchReg = readPort();
+
     return count;
 }
 
@@ -63,6 +63,9 @@ class gnublin_module_sc16is750 : public gnublin_module_sc16is7x0 {
     unsigned char ioLatchReg;
     void (*isrIO)(int, int);
 
+ protected :
+    int serviceInt(int interrupt);
+
  public :
     gnublin_module_sc16is750(int address = 0x20, std::string filename = "/dev/i2c-1");
     int init(void);
@@ -81,7 +84,6 @@ class gnublin_module_sc16is750 : public gnublin_module_sc16is7x0 {
     unsigned char readIntFlagPort(void);
 
     /* Interrupts */
-    int pollInt(void);
     int intIsrIO(void (*isr)(int, int));
 };
 
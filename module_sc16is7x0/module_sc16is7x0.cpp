@@ -47,6 +47,8 @@
 
 /* -------------------------------------------------------------------------- */
 
+#include <algorithm>
+
 #include "module_sc16is7x0.h"
 
 /* -------------------------------------------------------------------------- */
@@ -66,8 +68,8 @@
 #define UART_TX_FIFO_56    0x30
 
 /* Default resume and halt triggers. */
-#define TRIGGER_DEFAULT_RESUME  48
-#define TRIGGER_DEFAULT_HALT    24
+#define TRIGGER_DEFAULT_RESUME  24
+#define TRIGGER_DEFAULT_HALT    48
 
 /* Default RX and TX fifo level. */
 #define RX_DEFAULT_LEVEL        1
@@ -75,6 +77,262 @@
 
 /* -------------------------------------------------------------------------- */
 
+/**
+ * @~english
+ * @brief Compute the deadline for the given timeout.
+ *
+ * @param deadline The deadline computed.
+ * @param timeout The timeout in milliseconds.
+ */
+static void deadlineSet(struct timespec *deadline, int timeout) {
+
+    clock_gettime(CLOCK_MONOTONIC, deadline);
+    deadline->tv_sec += timeout / 1000;
+    deadline->tv_nsec += (timeout % 1000) * 1000000L;
+    if (deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000L;
+    }
+}
+
+
+/**
+ * @~english
+ * @brief Return the time left before the given deadline.
+ *
+ * @param deadline The deadline.
+ * @return The time left in milliseconds (0 when the deadline is reached).
+ */
+static int deadlineLeft(const struct timespec *deadline) {
+
+    struct timespec now;
+    long left;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    left = (deadline->tv_sec - now.tv_sec) * 1000 + (deadline->tv_nsec - now.tv_nsec) / 1000000L;
+    if (left < 0) {
+        return 0;
+    }
+
+    return left;
+}
+
+
+/**
+ * @~english
+ * @brief Add a register write to a list of accesses.
+ *
+ * @param xfers The list of accesses.
+ * @param values The values written by the accesses.
+ * @param count The number of accesses in the list, incremented.
+ * @param reg The register to write.
+ * @param value The value to write.
+ */
+static void planWrite(sc16is7x0_xfer *xfers, unsigned char *values, int *count, unsigned char reg, unsigned char value) {
+
+    values[*count] = value;
+    xfers[*count].reg = reg;
+    xfers[*count].read = 0;
+    xfers[*count].buffer = values + *count;
+    xfers[*count].len = 1;
+    (*count)++;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @~english
+ * @brief Set the default configuration (9600 baud, 8N1, flow control and
+ * FIFO disabled, interrupts disabled).
+ */
+sc16is7x0_uart_config::sc16is7x0_uart_config(void) {
+
+    baudRate = UART_9600;
+    format = UART_8N1;
+    flow = CONF_FLOW_DISABLED;
+    flowResume = TRIGGER_DEFAULT_RESUME;
+    flowHalt = TRIGGER_DEFAULT_HALT;
+    xon[0] = xon[1] = XON_DEFAULT;
+    xoff[0] = xoff[1] = XOFF_DEFAULT;
+    fifoEnable = 0;
+    rxTriggerLevel = 8;
+    txTriggerLevel = 8;
+    interrupt = CONF_INT_DISABLED;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @~english
+ * @brief Create an empty histogram.
+ */
+sc16is7x0_histogram::sc16is7x0_histogram(void) {
+
+    reset();
+}
+
+
+/**
+ * @~english
+ * @brief Remove all the values.
+ */
+void sc16is7x0_histogram::reset(void) {
+
+    memset(buckets, 0, sizeof(buckets));
+    count = 0;
+    min = 0;
+    max = 0;
+    sum = 0;
+}
+
+
+/**
+ * @~english
+ * @brief Record a value.
+ *
+ * @param value The value.
+ */
+void sc16is7x0_histogram::record(unsigned long value) {
+
+    if (value > 0xffffffffUL) {
+        value = 0xffffffffUL;
+    }
+
+    buckets[bucketIndex(value)]++;
+    if ((count == 0) || (value < min)) {
+        min = value;
+    }
+    if (value > max) {
+        max = value;
+    }
+    sum += value;
+    count++;
+}
+
+
+/**
+ * @~english
+ * @brief Get the number of values recorded.
+ *
+ * @return The number of values.
+ */
+unsigned long sc16is7x0_histogram::getCount(void) const {
+
+    return count;
+}
+
+
+/**
+ * @~english
+ * @brief Get the smallest value recorded.
+ *
+ * @return The smallest value (0 when empty).
+ */
+unsigned long sc16is7x0_histogram::getMin(void) const {
+
+    return min;
+}
+
+
+/**
+ * @~english
+ * @brief Get the largest value recorded.
+ *
+ * @return The largest value (0 when empty).
+ */
+unsigned long sc16is7x0_histogram::getMax(void) const {
+
+    return max;
+}
+
+
+/**
+ * @~english
+ * @brief Get the mean of the values recorded.
+ *
+ * @return The mean (0 when empty).
+ */
+double sc16is7x0_histogram::getMean(void) const {
+
+    return (count > 0) ? (double)sum / count : 0.0;
+}
+
+
+/**
+ * @~english
+ * @brief Get the value below which the given percentage of the values
+ * recorded fall. The value is the upper bound of the bucket.
+ *
+ * @param percent The percentage (0 to 100).
+ * @return The value (0 when empty).
+ */
+unsigned long sc16is7x0_histogram::getPercentile(double percent) const {
+
+    unsigned long long rank;
+    unsigned long long cumulated = 0;
+
+    if (count == 0) {
+        return 0;
+    }
+
+    rank = (unsigned long long)(percent * count / 100.0 + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        cumulated += buckets[i];
+        if (cumulated >= rank) {
+            unsigned long value = bucketValue(i + 1) - 1;
+            return (value < max) ? value : max;
+        }
+    }
+
+    return max;
+}
+
+
+/**
+ * @~english
+ * @brief Get the bucket of a value. The values below 2 * SUB_BUCKETS have
+ * their own bucket, the bucket of the other values is given by the
+ * position of their most significant bit and the next bits.
+ *
+ * @param value The value.
+ * @return The index of the bucket.
+ */
+int sc16is7x0_histogram::bucketIndex(unsigned long value) {
+
+    if (value < 2 * HISTOGRAM_SUB_BUCKETS) {
+        return value;
+    }
+
+    int msb = 31 - __builtin_clz((unsigned int)value);
+    int shift = msb - 3;
+
+    return shift * HISTOGRAM_SUB_BUCKETS + (value >> shift);
+}
+
+
+/**
+ * @~english
+ * @brief Get the lowest value of a bucket.
+ *
+ * @param index The index of the bucket.
+ * @return The lowest value.
+ */
+unsigned long sc16is7x0_histogram::bucketValue(int index) {
+
+    if (index < 2 * HISTOGRAM_SUB_BUCKETS) {
+        return index;
+    }
+
+    int shift = index / HISTOGRAM_SUB_BUCKETS - 1;
+    return (unsigned long)(index % HISTOGRAM_SUB_BUCKETS + HISTOGRAM_SUB_BUCKETS) << shift;
+}
+
+/* -------------------------------------------------------------------------- */
+
 /**
  * @~english
  * @brief Set the given i2c address to 0x20 and the given i2c file to /dev/i2c-1.
@@ -85,14 +343,59 @@
 gnublin_module_sc16is7x0::gnublin_module_sc16is7x0(int address, std::string filename) {
 
     errorFlag = false;
+    transport = &i2c;
     setAddress(address);
     setDevicefile(filename);
+    xtalFrequency = XTAL_FREQ;
+
+    resetConfig();
+    rxLevel = 0;
+    txSpace = 0;
+
+    txBufferEnable = 0;
+    txHead = 0;
+    txCount = 0;
+
+    rxData = rxBuffer;
+    rxSize = RX_BUFFER_SIZE;
+    rxHead = 0;
+    rxCount = 0;
+    rxScanned = 0;
+    rxScanDelim = '\n';
+
 
-    config.fifoEnable = 0;
-    config.fcrRegister = 0x00;
-    
     isrDataReceived = NULL;
+    isrDataReceivedContext = NULL;
+    isrDataTimestamp = NULL;
+    isrDataTimestampContext = NULL;
+    memset(&rxTimestamp, 0, sizeof(rxTimestamp));
     isrSpaceAvailable = NULL;
+    isrXoff = NULL;
+    isrXoffContext = NULL;
+    isrModem = NULL;
+    isrModemContext = NULL;
+    isrRxTimeout = NULL;
+    isrRxTimeoutContext = NULL;
+    rxFraming = 0;
+    rxKeep = 0;
+    modemStatus = 0;
+    txParked = 0;
+
+    serviceBudget = 0;
+    serviceMore = 0;
+    adaptiveEnable = 0;
+    rxPollEnable = 0;
+    rxPolling = 0;
+    rxPollIdle = RX_POLL_IDLE;
+    rxPollEmpty = 0;
+    rxPollInterval = RX_POLL_INTERVAL;
+    adaptiveRate = ADAPTIVE_DEFAULT_RATE;
+    adaptiveLatency = ADAPTIVE_DEFAULT_LATENCY;
+    resetIntStats();
+
+    rxErrors = NULL;
+    rxErrorsSize = 0;
+    resetLineStats();
 }
 
 
@@ -166,6 +469,41 @@ void gnublin_module_sc16is7x0::setDevicefile(std::string filename) {
 }
 
 
+/**
+ * @~english
+ * @brief Set the transport used to access the chip registers (SPI or mock
+ * transport). The I2C transport is used by default. The transport must
+ * remain valid as long as it is used.
+ *
+ * @param transport The transport or NULL to use the I2C transport.
+ * @return 1 on success.
+ */
+int gnublin_module_sc16is7x0::setTransport(sc16is7x0_transport *transport) {
+
+    if (transport == NULL) {
+        transport = &i2c;
+    }
+
+    this->transport = transport;
+    rxLevel = 0;
+    txSpace = 0;
+
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Get the transport used to access the chip registers.
+ *
+ * @return The transport.
+ */
+sc16is7x0_transport *gnublin_module_sc16is7x0::getTransport(void) {
+
+    return transport;
+}
+
+
 /**
  * @~english
  * @brief Initialize the UART.
@@ -175,55 +513,243 @@ void gnublin_module_sc16is7x0::setDevicefile(std::string filename) {
 int gnublin_module_sc16is7x0::initUART(void) {
 
     errorFlag = false;
+    sc16is7x0_uart_config uartConfig;
 
-    if (setBaudRate(UART_9600) < 0) {
+    if (configure(&uartConfig) < 0) {
         errorFlag = true;
         return -1;
     }
-    
-    if (setDataFormat(UART_8N1) < 0) {
-        errorFlag = true;
+
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Apply the given UART configuration at once. The final value of
+ * the registers is computed from the configuration and the shadow
+ * registers. Only the registers whose value changes are written, in the
+ * order allowing their access (EFR and XON/XOFF, DLL/DLH, LCR, MCR,
+ * TCR/TLR, FCR and IER). The writes are sent in a single transaction when the transport
+ * allows it. The RX and TX FIFO are reset. The special character (XOFF2,
+ * see setSpecialChar) is kept. In multidrop mode the address is kept and
+ * the parity is forced to 0 (see setMultidrop).
+ *
+ * @param uartConfig The configuration to apply.
+ * @return -1 on error or the number of transactions used.
+ */
+int gnublin_module_sc16is7x0::configure(sc16is7x0_uart_config *uartConfig) {
+
+    errorFlag = false;
+    unsigned long transactions = transport->getTransactions();
+    sc16is7x0_xfer xfers[TRANSPORT_MAX_XFERS];
+    unsigned char values[TRANSPORT_MAX_XFERS];
+    int count = 0;
+    unsigned int divisor;
+    unsigned int prescaler;
+    float error;
+
+    if (computeDivisor(uartConfig->baudRate, &divisor, &prescaler, &error) < 0) {
         return -1;
     }
 
-    if (resetRxFifo() < 0) {
+    if (uartConfig->format & (1 << 7)) {
         errorFlag = true;
+        errorMessage = "Invalid data format\n";
         return -1;
     }
-    
-    if (resetTxFifo() < 0) {
+
+    if ((uartConfig->flowResume > 60) || (uartConfig->flowResume % 4 != 0) ||
+        (uartConfig->flowHalt > 60) || (uartConfig->flowHalt % 4 != 0) ||
+        (uartConfig->flowHalt < uartConfig->flowResume)) {
         errorFlag = true;
+        errorMessage = "Invalid flow control triggers\n";
         return -1;
     }
 
-    if (enableFifo(0) < 0) {
-        errorFlag = true;
-        return -1;
+    /* Compute the final value of the registers. EFR[4] is kept set
+       (enhanced functions) so that MCR[7], MCR[2], IER[7:4] and FCR[5:4]
+       could be written. */
+    unsigned char lcrValue = uartConfig->format;
+    unsigned char efrValue = (config.efrRegister & ~CONF_FLOW_MASK) | (uartConfig->flow & CONF_FLOW_MASK) | (1 << 4);
+    unsigned char mcrValue = config.mcrRegister & ~(1 << 7);
+    unsigned char tcrValue = config.tcrRegister;
+    unsigned char tlrValue = config.tlrRegister;
+    unsigned char fcrValue = config.fcrRegister & ~(1 << 0);
+    unsigned char ierValue = CONF_INT_NONE | uartConfig->interrupt;
+    unsigned char xoffValue[2] = {uartConfig->xoff[0], uartConfig->xoff[1]};
+
+    /* XOFF2 is the special character or the multidrop address, it is
+       kept. */
+    if (efrValue & CONF_SPECIAL_CHAR) {
+        if (uartConfig->flow & (CONF_FLOW_TX_XON2 | CONF_FLOW_RX_XON2)) {
+            errorFlag = true;
+            if (config.efcrRegister & CONF_MULTIDROP) {
+                errorMessage = "XON2/XOFF2 flow control is not available in multidrop mode\n";
+            }
+            else {
+                errorMessage = "XON2/XOFF2 flow control is not available with the special character\n";
+            }
+            return -1;
+        }
+        xoffValue[1] = config.xoffRegister[1];
     }
 
-    if (setFlowControl(CONF_FLOW_DISABLED) < 0) {
-    	errorFlag = true;
-        return -1;
+    /* The parity bit is the address flag in multidrop mode. */
+    if (config.efcrRegister & CONF_MULTIDROP) {
+        lcrValue |= CONF_FORCE_PARITY_0;
     }
-    
-#if (USE_ENHANCED_FIFO)
-    if (setFlowTriggers(TRIGGER_DEFAULT_RESUME, TRIGGER_DEFAULT_HALT) < 0) {
-    	errorFlag = true;
-        return -1;
+
+    if (prescaler == 4) {
+        mcrValue |= (1 << 7);
     }
+
+#if (USE_ENHANCED_FIFO)
+    mcrValue |= (1 << 2);
+    tcrValue = ((uartConfig->flowResume / 4) << 4) | (uartConfig->flowHalt / 4);
 #endif
 
-    if (setModemControl() < 0) {
-    	errorFlag = true;
-        return -1;
+    if (uartConfig->fifoEnable) {
+        unsigned int rxTrigger = uartConfig->rxTriggerLevel;
+        unsigned int txTrigger = uartConfig->txTriggerLevel;
+
+        fcrValue |= (1 << 0);
+
+#if (USE_ENHANCED_FIFO)
+        if ((rxTrigger < 4) || (rxTrigger > 60) || (rxTrigger % 4 != 0) ||
+            (txTrigger < 4) || (txTrigger > 60) || (txTrigger % 4 != 0)) {
+            errorFlag = true;
+            errorMessage = "Level is not a multiple of 4 between 4 and 60\n";
+            return -1;
+        }
+
+        tlrValue = ((rxTrigger / 4) << 4) | (txTrigger / 4);
+        fcrValue &= (UART_RX_FIFO_CLEAR & UART_TX_FIFO_CLEAR);
+#else
+        fcrValue &= (UART_RX_FIFO_CLEAR & UART_TX_FIFO_CLEAR);
+        switch (rxTrigger) {
+        case 8 : fcrValue |= UART_RX_FIFO_8; break;
+        case 16 : fcrValue |= UART_RX_FIFO_16; break;
+        case 56 : fcrValue |= UART_RX_FIFO_56; break;
+        case 60 : fcrValue |= UART_RX_FIFO_60; break;
+        default :
+            errorFlag = true;
+            errorMessage = "Level is not 8, 16, 56 or 60\n";
+            return -1;
+        }
+        switch (txTrigger) {
+        case 8 : fcrValue |= UART_TX_FIFO_8; break;
+        case 16 : fcrValue |= UART_TX_FIFO_16; break;
+        case 32 : fcrValue |= UART_TX_FIFO_32; break;
+        case 56 : fcrValue |= UART_TX_FIFO_56; break;
+        default :
+            errorFlag = true;
+            errorMessage = "Level is not 8, 16, 32 or 56\n";
+            return -1;
+        }
+
+        /* The FCR trigger levels are only used when TLR is 0. */
+        tlrValue = 0x00;
+#endif
     }
-    
-    if (setInterrupt(CONF_INT_DISABLED) < 0) {
+
+    /* EFR, XON and XOFF are only accessible when LCR is 0xBF. */
+    if ((efrValue != config.efrRegister) ||
+        (memcmp(uartConfig->xon, config.xonRegister, 2) != 0) ||
+        (memcmp(xoffValue, config.xoffRegister, 2) != 0)) {
+        planWrite(xfers, values, &count, LCR, 0xbf);
+        if (efrValue != config.efrRegister) {
+            planWrite(xfers, values, &count, EFR, efrValue);
+        }
+        for (int i = 0; i < 2; i++) {
+            if (uartConfig->xon[i] != config.xonRegister[i]) {
+                planWrite(xfers, values, &count, XON1 + i, uartConfig->xon[i]);
+            }
+            if (xoffValue[i] != config.xoffRegister[i]) {
+                planWrite(xfers, values, &count, XOFF1 + i, xoffValue[i]);
+            }
+        }
+    }
+
+    /* DLL and DLH are only accessible when LCR[7] is set. */
+    if (divisor != config.divisor) {
+        planWrite(xfers, values, &count, LCR, lcrValue | (1 << 7));
+        planWrite(xfers, values, &count, DLL, divisor & 0xff);
+        planWrite(xfers, values, &count, DLH, divisor >> 8);
+    }
+
+    if ((count > 0) || (lcrValue != config.lcrRegister)) {
+        planWrite(xfers, values, &count, LCR, lcrValue);
+    }
+
+    /* TCR and TLR are only accessible when MCR[2] and EFR[4] are set. */
+    if ((tcrValue != config.tcrRegister) || (tlrValue != config.tlrRegister)) {
+        if (!(mcrValue & (1 << 2))) {
+            planWrite(xfers, values, &count, MCR, mcrValue | (1 << 2));
+        }
+        else if (mcrValue != config.mcrRegister) {
+            planWrite(xfers, values, &count, MCR, mcrValue);
+        }
+
+        if (tcrValue != config.tcrRegister) {
+            planWrite(xfers, values, &count, TCR, tcrValue);
+        }
+        if (tlrValue != config.tlrRegister) {
+            planWrite(xfers, values, &count, TLR, tlrValue);
+        }
+
+        if (!(mcrValue & (1 << 2))) {
+            planWrite(xfers, values, &count, MCR, mcrValue);
+        }
+    }
+    else if (mcrValue != config.mcrRegister) {
+        planWrite(xfers, values, &count, MCR, mcrValue);
+    }
+
+    /* FCR is write only, it is always written to reset the FIFO. */
+    planWrite(xfers, values, &count, FCR, fcrValue | (1 << 1) | (1 << 2));
+
+    if (ierValue != config.ierRegister) {
+        planWrite(xfers, values, &count, IER, ierValue);
+    }
+
+    if (transport->transfer(xfers, count) < 0) {
         errorFlag = true;
+        errorMessage = "transfer (configure) Error\n";
+
+        /* The state of the chip is unknown. */
+        config.divisor = 0;
         return -1;
     }
 
-    return 1;
+    config.lcrRegister = lcrValue;
+    config.efrRegister = efrValue;
+    memcpy(config.xonRegister, uartConfig->xon, 2);
+    memcpy(config.xoffRegister, xoffValue, 2);
+    config.mcrRegister = mcrValue;
+    config.tcrRegister = tcrValue;
+    config.tlrRegister = tlrValue;
+    config.fcrRegister = fcrValue;
+    config.ierRegister = ierValue;
+    config.divisor = divisor;
+    config.baudRate = xtalFrequency / (16 * prescaler * divisor);
+    config.baudRateError = error;
+    config.fifoEnable = uartConfig->fifoEnable;
+    rxLevel = 0;
+    txSpace = 0;
+
+    /* The interrupts are the ones configured, the RX polling is left. */
+    rxPolling = 0;
+
+    /* The CTS state is tracked from the modem interrupts. */
+    txParked = 0;
+    if (ierValue & (CONF_INT_MSEN | CONF_INT_CTSEN)) {
+        if (readModemStatus() < 0) {
+            return -1;
+        }
+    }
+
+    return transport->getTransactions() - transactions;
 }
 
 
@@ -237,109 +763,154 @@ int gnublin_module_sc16is7x0::softReset(void) {
     unsigned char rxValue;
     unsigned char txValue;
 
-    if (i2c.receive(IOCTRL, &rxValue, 1) < 0) {
+    if (transport->receive(IOCTRL, &rxValue, 1) < 0) {
         errorFlag = true;
-        errorMessage = "i2c.receive (IOCTRL) Error\n";
+        errorMessage = "receive (IOCTRL) Error\n";
         return -1;
     }
         
     txValue = rxValue | (1 << 3);
-    if (i2c.send(IOCTRL, &txValue, 1) < 0) {
+    if (transport->send(IOCTRL, &txValue, 1) < 0) {
         errorFlag = true;
-        errorMessage = "i2c.send (IOCTRL) Error\n";
+        errorMessage = "send (IOCTRL) Error\n";
         return -1;
     }
 
+    /* The chip registers are back to their reset values. */
+    resetConfig();
+    modemStatus = 0;
+    txParked = 0;
+    rxLevel = 0;
+    txSpace = 0;
+
     return 1;
 }
 
 
 /**
  * @~english
- * @brief Set the UART speed.
+ * @brief Read the configuration registers from the chip into the shadow
+ * registers. This is only needed when the chip has been configured outside
+ * of this instance without being reset (see init). The FCR is write only
+ * and keep its shadow value.
  *
- * @param baud The speed to set.
  * @return -1 on error and 1 on success.
  */
-int gnublin_module_sc16is7x0::setBaudRate(unsigned int baud) {
+int gnublin_module_sc16is7x0::syncConfig(void) {
 
     errorFlag = false;
+    unsigned char dllValue;
+    unsigned char dlhValue;
 
-    if ((baud < UART_300) || (baud > UART_230400)) {
+    if (transport->receive(LCR, &config.lcrRegister, 1) < 0) {
         errorFlag = true;
-        sprintf(const_cast<char*>(errorMessage.c_str()), "Baud rate is not between %d and %d\n", UART_300, UART_230400);
+        errorMessage = "receive (LCR) Error\n";
         return -1;
     }
 
-    unsigned int divisor = XTAL_FREQ / (baud * 16);
-    unsigned char divisorLSB = divisor;
-    unsigned char divisorMSB = divisor >> 8;
-
-    /* Set the LCR[7] to access the DLL and DLH register. */
-    unsigned char txValue;
-    unsigned char lcrValue;
-    
-    if (i2c.receive(LCR, &lcrValue, 1) < 0) {
+    if (transport->receive(MCR, &config.mcrRegister, 1) < 0) {
         errorFlag = true;
-        errorMessage = "i2c.receive (LCR) Error\n";
+        errorMessage = "receive (MCR) Error\n";
         return -1;
     }
 
-    txValue = lcrValue | (1 << 7);
-    if (i2c.send(LCR, &txValue, 1) < 0) {
+    if (transport->receive(IER, &config.ierRegister, 1) < 0) {
         errorFlag = true;
-        errorMessage = "i2c.send (LCR) Error\n";
+        errorMessage = "receive (IER) Error\n";
         return -1;
     }
 
-    /* Set the baud rate. */
-    if (i2c.send(DLL, &divisorLSB, 1) < 0) {
+    if (transport->receive(EFCRF, &config.efcrRegister, 1) < 0) {
         errorFlag = true;
-        errorMessage = "i2c.send (DLL) Error\n";
+        errorMessage = "receive (EFCR) Error\n";
         return -1;
     }
-    if (i2c.send(DLH, &divisorMSB, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (DLH) Error\n";
+
+    /* Set LCR[7] to access the DLL and DLH register. */
+    if (writeRegister(LCR, config.lcrRegister | (1 << 7), "LCR") < 0) {
         return -1;
     }
 
-    /* Restore the LCR register. */
-    if (i2c.send(LCR, &lcrValue, 1) < 0) {
+    if ((transport->receive(DLL, &dllValue, 1) < 0) || (transport->receive(DLH, &dlhValue, 1) < 0)) {
         errorFlag = true;
-        errorMessage = "i2c.receive (LCR) Error\n";
+        errorMessage = "receive (DLL/DLH) Error\n";
         return -1;
     }
+    config.divisor = (dlhValue << 8) | dllValue;
+    if (config.divisor != 0) {
+        unsigned int prescaler = (config.mcrRegister & (1 << 7)) ? 4 : 1;
+        config.baudRate = xtalFrequency / (16 * prescaler * config.divisor);
+        config.baudRateError = 0.0;
+    }
+
+    /* Set LCR to 0xBF to enable access to EFR, XON and XOFF registers. */
+    if (writeRegister(LCR, 0xbf, "LCR") < 0) {
+        return -1;
+    }
+
+    if (transport->receive(EFR, &config.efrRegister, 1) < 0) {
+        errorFlag = true;
+        errorMessage = "receive (EFR) Error\n";
+        return -1;
+    }
+
+    for (int i = 0; i < 2; i++) {
+        if ((transport->receive(XON1 + i, &config.xonRegister[i], 1) < 0) ||
+            (transport->receive(XOFF1 + i, &config.xoffRegister[i], 1) < 0)) {
+            errorFlag = true;
+            errorMessage = "receive (XON/XOFF) Error\n";
+            return -1;
+        }
+    }
+
+    /* Restore the LCR register. */
+    if (writeRegister(LCR, config.lcrRegister, "LCR") < 0) {
+        return -1;
+    }
+
+    /* TCR and TLR are only readable when MCR[2] and EFR[4] are set. */
+    if ((config.mcrRegister & (1 << 2)) && (config.efrRegister & (1 << 4))) {
+        if (transport->receive(TCR, &config.tcrRegister, 1) < 0) {
+            errorFlag = true;
+            errorMessage = "receive (TCR) Error\n";
+            return -1;
+        }
+
+        if (transport->receive(TLR, &config.tlrRegister, 1) < 0) {
+            errorFlag = true;
+            errorMessage = "receive (TLR) Error\n";
+            return -1;
+        }
+    }
+
+    return 1;
+}
 
-    return 1;
-}
-
 
 /**
  * @~english
- * @brief Set the data communication format. Word length, stop bit and parity.
+ * @brief Set the frequency of the crystal connected to the chip. The baud
+ * rate must be set again after changing the frequency.
  *
- * @param baud The speed to set.
+ * @param frequency The crystal frequency in Hz.
  * @return -1 on error and 1 on success.
  */
-int gnublin_module_sc16is7x0::setDataFormat(unsigned char format) {
+int gnublin_module_sc16is7x0::setCrystalFrequency(unsigned long frequency) {
 
     errorFlag = false;
-    unsigned char rxValue;
-    unsigned char txValue;
 
-    if (i2c.receive(LCR, &rxValue, 1) < 0) {
+    if (frequency == 0) {
         errorFlag = true;
-        errorMessage = "i2c.receive (LCR) Error\n";
+        errorMessage = "Invalid crystal frequency\n";
         return -1;
     }
 
-    txValue = format;
-    if (i2c.send(LCR, &txValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (LCR) Error\n";
-        return -1;
-    }
+    xtalFrequency = frequency;
+
+    /* The divisor must be computed again. */
+    config.divisor = 0;
+    config.baudRate = 0;
+    config.baudRateError = 0.0;
 
     return 1;
 }
@@ -347,80 +918,143 @@ int gnublin_module_sc16is7x0::setDataFormat(unsigned char format) {
 
 /**
  * @~english
- * @brief Set the modem control.
- * Enable TCR and TLR registers.
+ * @brief Set the UART speed. The divisor giving the smallest error is
+ * selected with and without the clock prescaler (MCR[7], divide by 4). The
+ * speed is rejected when the error is above BAUD_MAX_ERROR percent. The
+ * actual speed and its error are given by getBaudRate and
+ * getBaudRateError.
+ *
+ * @param baud The speed to set.
+ * @return -1 on error and 1 on success.
  */
-int gnublin_module_sc16is7x0::setModemControl(void) {
+int gnublin_module_sc16is7x0::setBaudRate(unsigned int baud) {
 
     errorFlag = false;
-    unsigned char txValue;
-    unsigned char lcrValue;
-    unsigned char efrValue;
-
-    /* MCR[2] can only be accessed when EFR[4] is set.
-       EFR can only be accessed when LCR is 0xBF. */
+    unsigned int divisor;
+    unsigned int prescaler;
+    float error;
 
-    if (i2c.receive(LCR, &lcrValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.receive (LCR) Error\n";
+    if (computeDivisor(baud, &divisor, &prescaler, &error) < 0) {
         return -1;
     }
 
-    /* Set LCR to 0xBF to enable access to EFR register. */
-    txValue = 0xbf;
-    if (i2c.send(LCR, &txValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (LCR) Error\n";
-        return -1;
+    unsigned char divisorLSB = divisor;
+    unsigned char divisorMSB = divisor >> 8;
+    unsigned char mcrValue = config.mcrRegister & ~(1 << 7);
+
+    if (prescaler == 4) {
+        mcrValue |= (1 << 7);
     }
 
-    if (i2c.receive(EFR, &efrValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.receive (EFR) Error\n";
-        return -1;
+    /* MCR[7] can only be modified when EFR[4] is set. */
+    if (mcrValue != config.mcrRegister) {
+        if (enableEnhancedFunctions() < 0) {
+            return -1;
+        }
+
+        if (updateRegister(MCR, &config.mcrRegister, mcrValue, "MCR") < 0) {
+            return -1;
+        }
     }
-    
-    /* Set EFR[4]. */
-    txValue = efrValue | (1 << 4);
-    if (i2c.send(EFR, &txValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (EFR) Error\n";
-        return -1;
+
+    if (config.divisor != divisor) {
+        /* Set the LCR[7] to access the DLL and DLH register. */
+        if (writeRegister(LCR, config.lcrRegister | (1 << 7), "LCR") < 0) {
+            return -1;
+        }
+
+        /* Set the baud rate. */
+        if (writeRegister(DLL, divisorLSB, "DLL") < 0) {
+            return -1;
+        }
+        if (writeRegister(DLH, divisorMSB, "DLH") < 0) {
+            return -1;
+        }
+
+        /* Restore the LCR register. */
+        if (writeRegister(LCR, config.lcrRegister, "LCR") < 0) {
+            return -1;
+        }
+
+        config.divisor = divisor;
     }
 
-    txValue = 0x00;
+    config.baudRate = xtalFrequency / (16 * prescaler * divisor);
+    config.baudRateError = error;
+
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Get the actual UART speed set by setBaudRate.
+ *
+ * @return The actual speed or 0 when unknown.
+ */
+unsigned int gnublin_module_sc16is7x0::getBaudRate(void) {
+
+    return config.baudRate;
+}
+
+
+/**
+ * @~english
+ * @brief Get the error of the actual UART speed set by setBaudRate.
+ *
+ * @return The error in percent.
+ */
+float gnublin_module_sc16is7x0::getBaudRateError(void) {
+
+    return config.baudRateError;
+}
+
+
+/**
+ * @~english
+ * @brief Set the data communication format. Word length, stop bit and parity.
+ *
+ * @param baud The speed to set.
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_module_sc16is7x0::setDataFormat(unsigned char format) {
+
+    errorFlag = false;
+
+    return updateRegister(LCR, &config.lcrRegister, format, "LCR");
+}
+
+
+/**
+ * @~english
+ * @brief Set the modem control.
+ * Enable TCR and TLR registers.
+ */
+int gnublin_module_sc16is7x0::setModemControl(void) {
+
+    errorFlag = false;
+
 #if (USE_ENHANCED_FIFO)
-    /* Set MCR[2] to enable TCR and TLR. */
-    txValue |= (1 << 2);
-#endif
-    if (i2c.send(MCR, &txValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.receive (MCR) Error\n";
-        return -1;
-    }
-    
-    /* Restore the EFR register. */
-    if (i2c.send(EFR, &efrValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (EFR) Error\n";
+    /* MCR[2] can only be accessed when EFR[4] is set.
+       Set MCR[2] to enable TCR and TLR. It is kept set so that TCR and
+       TLR could be written without touching MCR. */
+    if (enableEnhancedFunctions() < 0) {
         return -1;
     }
 
-    /* Restore the LCR register. */
-    if (i2c.send(LCR, &lcrValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (LCR) Error\n";
-        return -1;
-    }
-    
+    return updateRegister(MCR, &config.mcrRegister, config.mcrRegister | (1 << 2), "MCR");
+#else
     return 1;
+#endif
 }
 
 
 /**
  * @~english
- * @brief Set the flow control according to the given mask.
- * Software flow control is not yet supported.
+ * @brief Set the flow control according to the given mask. The hardware
+ * (CTS, RTS) and software (XON/XOFF) flow control could be combined. The
+ * software flow control characters are set with setXonXoff. The halt and
+ * resume levels are set with setFlowTriggers.
  *
  * @param flow The bit mask to set the flow control.
  * @return -1 on error and 1 on success.
@@ -430,40 +1064,98 @@ int gnublin_module_sc16is7x0::setFlowControl(unsigned char flow) {
     //printf("setFlowControl(flow=0x%02x)\n", flow);
 
     errorFlag = false;
-    unsigned char txValue;
-    unsigned char lcrValue;
 
-    /* EFR can only be accessed when LCR is 0xBF. */
-
-    if (i2c.receive(LCR, &lcrValue, 1) < 0) {
+    /* The RTS pin could not drive the flow control and the transceiver. */
+    if ((flow & CONF_FLOW_RTS) && (config.efcrRegister & CONF_RS485_AUTO)) {
         errorFlag = true;
-        errorMessage = "i2c.receive (LCR) Error\n";
+        errorMessage = "RTS flow control is not available in RS-485 mode\n";
         return -1;
     }
 
-    /* Set LCR to 0xBF to enable access to EFR register. */
-    txValue = 0xbf;
-    if (i2c.send(LCR, &txValue, 1) < 0) {
+    /* XOFF2 is the special character. */
+    if ((flow & (CONF_FLOW_TX_XON2 | CONF_FLOW_RX_XON2)) && (config.efrRegister & CONF_SPECIAL_CHAR)) {
         errorFlag = true;
-        errorMessage = "i2c.send (LCR) Error\n";
+        errorMessage = "XON2/XOFF2 flow control is not available with the special character\n";
         return -1;
     }
 
-    /* Set EFR with given flow mask. */
-    txValue = flow;
-    if (i2c.send(EFR, &txValue, 1) < 0) {
+    /* EFR[4] is kept set (enhanced functions). */
+    return updateEFR((config.efrRegister & ~CONF_FLOW_MASK) | (flow & CONF_FLOW_MASK) | (1 << 4));
+}
+
+
+/**
+ * @~english
+ * @brief Set the RS-485 half-duplex mode. The chip drives the direction of
+ * the transceiver with the RTS pin (EFCR[4]), the driver is enabled while
+ * the TX FIFO and the TSR hold data. No turnaround is done by the host, see
+ * waitTxComplete for waiting the end of the transmission before a
+ * response.
+ *
+ * @param mode CONF_RS485_NONE, CONF_RS485_AUTO or CONF_RS485_AUTO |
+ * CONF_RS485_INVERT (for transceivers with an active high driver enable).
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_module_sc16is7x0::setRs485(unsigned char mode) {
+
+    errorFlag = false;
+
+    /* The RTS pin could not drive the flow control and the transceiver. */
+    if ((mode & CONF_RS485_AUTO) && (config.efrRegister & CONF_FLOW_RTS)) {
         errorFlag = true;
-        errorMessage = "i2c.send (EFR) Error\n";
+        errorMessage = "RS-485 mode is not available with RTS flow control\n";
         return -1;
     }
 
-    /* Restore the LCR register. */
-    if (i2c.send(LCR, &lcrValue, 1) < 0) {
+    return updateRegister(EFCRF, &config.efcrRegister, (config.efcrRegister & ~CONF_RS485_MASK) | (mode & CONF_RS485_MASK), "EFCR");
+}
+
+
+/**
+ * @~english
+ * @brief Set the software flow control characters. The registers are
+ * written in a single transaction, only when their value changes.
+ *
+ * @param xon1 The XON1 character.
+ * @param xoff1 The XOFF1 character.
+ * @param xon2 The XON2 character.
+ * @param xoff2 The XOFF2 character.
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_module_sc16is7x0::setXonXoff(unsigned char xon1, unsigned char xoff1, unsigned char xon2, unsigned char xoff2) {
+
+    errorFlag = false;
+    unsigned char xon[2] = {xon1, xon2};
+    unsigned char xoff[2] = {xoff1, xoff2};
+    sc16is7x0_xfer xfers[6];
+    unsigned char values[6];
+    int count = 0;
+
+    /* XON and XOFF are only accessible when LCR is 0xBF. */
+    planWrite(xfers, values, &count, LCR, 0xbf);
+    for (int i = 0; i < 2; i++) {
+        if (xon[i] != config.xonRegister[i]) {
+            planWrite(xfers, values, &count, XON1 + i, xon[i]);
+        }
+        if (xoff[i] != config.xoffRegister[i]) {
+            planWrite(xfers, values, &count, XOFF1 + i, xoff[i]);
+        }
+    }
+    planWrite(xfers, values, &count, LCR, config.lcrRegister);
+
+    if (count == 2) {
+        /* Nothing changes. */
+        return 1;
+    }
+
+    if (transport->transfer(xfers, count) < 0) {
         errorFlag = true;
-        errorMessage = "i2c.send (LCR) Error\n";
+        errorMessage = "transfer (XON/XOFF) Error\n";
         return -1;
     }
 
+    memcpy(config.xonRegister, xon, 2);
+    memcpy(config.xoffRegister, xoff, 2);
     return 1;
 }
 
@@ -484,14 +1176,11 @@ int gnublin_module_sc16is7x0::setFlowTriggers(unsigned int resume, unsigned int
     printf("Flow triggers could only be set in enhanced mode.\n");
     return 1;
 #endif
-    
+
     errorFlag = false;
-    unsigned char txValue;
-    unsigned char lcrValue;
-    unsigned char efrValue;
 
     /* Sanity checks for resume and halt values. */
-    if ((resume < 0) && (resume > 60)) {
+    if (resume > 60) {
         errorFlag = true;
         errorMessage = "Resume is not between 4 and 60\n";
         return -1;
@@ -503,7 +1192,7 @@ int gnublin_module_sc16is7x0::setFlowTriggers(unsigned int resume, unsigned int
         return -1;
     }
 
-    if ((halt < 0) && (halt > 60)) {
+    if (halt > 60) {
         errorFlag = true;
         errorMessage = "Halt is not between 4 and 60\n";
         return -1;
@@ -515,77 +1204,24 @@ int gnublin_module_sc16is7x0::setFlowTriggers(unsigned int resume, unsigned int
         return -1;
     }
 
-    if (halt > resume) {
+    if (halt < resume) {
        	errorFlag = true;
         errorMessage = "Halt can not be lower than resume\n";
         return -1;
     }
-    
-    if (i2c.receive(LCR, &lcrValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.receive (LCR) Error\n";
-        return -1;
-    }
-
-    /* TCR can only be accessed when EFR[4] and MCR[2] are set. EFR can only be
-       accessed when LCR is 0xBF.
-       MCR[2] has already been set in setModemControl. */
-
-    /* Set LCR to 0xBF to enable access to EFR register. */
-    txValue = 0xbf;
-    if (i2c.send(LCR, &txValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (LCR) Error\n";
-        return -1;
-    }
-
-    if (i2c.receive(EFR, &efrValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.receive (EFR) Error\n";
-        return -1;
-    }
-
-    /* Set EFR[4]. */
-    txValue = efrValue | (1 << 4);
-    if (i2c.send(EFR, &txValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (EFR) Error\n";
-        return -1;
-    }
 
-    
     /* Set TCR.
      * TCR[0-3] : RX Fifo trigger level to halt transmission.
      * TCR[4-7] : RX Fifo trigger level to resume.
      */
-    txValue = ((resume / 4) << 4) | (halt / 4);
-    if (i2c.send(TCR, &txValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (TCR) Error\n";
-        return -1;
-    }
-
-    /* Restore the EFR register. */
-    if (i2c.send(EFR, &efrValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (EFR) Error\n";
-        return -1;
-    }
-
-    /* Restore the LCR register. */
-    if (i2c.send(LCR, &lcrValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (LCR) Error\n";
-        return -1;
-    }
-    
-    return 1;
+    return updateTcrTlr(TCR, &config.tcrRegister, ((resume / 4) << 4) | (halt / 4), "TCR");
 }
 
 
 /**
  * @~english
- * @brief Set the interrupt to enable.
+ * @brief Set the interrupt to enable. When the modem interrupts are
+ * enabled, the MSR is read to get the initial state of CTS.
  *
  * @param interrupt Interrupt mask to set to enable interrupts.
  * @return -1 on error and 1 on success.
@@ -593,71 +1229,29 @@ int gnublin_module_sc16is7x0::setFlowTriggers(unsigned int resume, unsigned int
 int gnublin_module_sc16is7x0::setInterrupt(unsigned char interrupt) {
 
     errorFlag = false;
-    unsigned char txValue;
-    unsigned char ierValue;
-    unsigned char lcrValue;
-    unsigned char efrValue;
-
-    /* IER can only be accessed when EFR[4] is set.
-       EFR can only be accessed when LCR is 0xBF.
-       IER[7:4] can only be accessed when EFR[4] is set. */
-    
-    if (i2c.receive(LCR, &lcrValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.receive (LCR) Error\n";
-        return -1;
-    }
-
-    /* Set LCR to 0xBF to enable access to EFR register. */
-    txValue = 0xbf;
-    if (i2c.send(LCR, &txValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (LCR) Error\n";
-        return -1;
-    }
 
-    if (i2c.receive(EFR, &efrValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.receive (EFR) Error\n";
-        return -1;
-    }
- 
-    /* Set EFR[4]. */
-    txValue = efrValue | (1 << 4);
-    if (i2c.send(EFR, &txValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (EFR) Error\n";
-        return -1;
+    /* IER[7:4] can only be modified when EFR[4] is set. */
+    if ((interrupt & 0xf0) != (config.ierRegister & 0xf0)) {
+        if (enableEnhancedFunctions() < 0) {
+            return -1;
+        }
     }
 
-    /* Set the UART interrupts for the 4 MSB. */
-    ierValue = (CONF_INT_NONE | interrupt) & 0xf0;
-    if (i2c.send(IER, &ierValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (IER) Error\n";
-        return -1;
-    }
+    int tracking = (config.ierRegister & (CONF_INT_MSEN | CONF_INT_CTSEN)) != 0;
 
-    /* Restore the EFR register. */
-    if (i2c.send(EFR, &efrValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (EFR) Error\n";
+    if (updateRegister(IER, &config.ierRegister, CONF_INT_NONE | interrupt, "IER") < 0) {
         return -1;
     }
+    rxPolling = 0;
 
-    /* Restore the LCR register. */
-    if (i2c.send(LCR, &lcrValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (LCR) Error\n";
-        return -1;
+    /* The CTS state is tracked from the modem interrupts. */
+    if ((interrupt & (CONF_INT_MSEN | CONF_INT_CTSEN)) == 0) {
+        txParked = 0;
     }
-
-    /* Set the UART interrupts for the 4 LSB. */
-    ierValue = ierValue | ((CONF_INT_NONE | interrupt) & 0x0f);
-    if (i2c.send(IER, &ierValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (IER) Error\n";
-        return -1;
+    else if (!tracking) {
+        if (readModemStatus() < 0) {
+            return -1;
+        }
     }
 
     return 1;
@@ -674,83 +1268,24 @@ int gnublin_module_sc16is7x0::setInterrupt(unsigned char interrupt) {
 int gnublin_module_sc16is7x0::enableFifo(int value) {
 
     errorFlag = false;
-#if !(USE_ENHANCED_FIFO)
-    unsigned char txValue;
-    unsigned char lcrValue;
-    unsigned char efrValue;
-#endif
+    unsigned char fcrValue;
 
-    /* FCR[4:5] can only be accessed when EFR[4] is set.
-       EFR can only be accessed when LCR is 0xBF. */
-
-#if !(USE_ENHANCED_FIFO)
-    if (i2c.receive(LCR, &lcrValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.receive (LCR) Error\n";
-        return -1;
+    if (value == 1) {
+        fcrValue = config.fcrRegister | (1 << 0);
+    }
+    else {
+        fcrValue = config.fcrRegister & ~(1 << 0);
     }
 
-    /* Set LCR to 0xBF to enable access to EFR register. */
-    txValue = 0xbf;
-    if (i2c.send(LCR, &txValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (LCR) Error\n";
+    /* FCR[5:4] can only be modified when EFR[4] is set. */
+    if (enableEnhancedFunctions() < 0) {
         return -1;
     }
 
-    if (i2c.receive(EFR, &efrValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.receive (EFR) Error\n";
+    if (updateRegister(FCR, &config.fcrRegister, fcrValue, "FCR") < 0) {
         return -1;
     }
 
-    /* Set EFR[4]. */
-    txValue = efrValue | (1 << 4);
-    if (i2c.send(EFR, &txValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (EFR) Error\n";
-        return -1;
-    }
-#endif
-    
-    /* Set FCR. */
-#if !(USE_ENHANCED_FIFO)
-    if (value == 1) {
-        config.fcrRegister |= (1 << 0);
-    }
-    else {
-        config.fcrRegister |= (config.fcrRegister & ~(1 << 0));
-    }
-#else
-    if (value == 1) {
-        config.fcrRegister = 0x01;
-    }
-    else {
-        config.fcrRegister = 0x00;
-    }
-#endif
-    if (i2c.send(FCR, &config.fcrRegister, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (FCR) Error\n";
-        return -1;
-    }
-    
-#if !(USE_ENHANCED_FIFO)
-    /* Restore the EFR register. */
-    if (i2c.send(EFR, &efrValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (EFR) Error\n";
-        return -1;
-    }
-
-    /* Restore the LCR register. */
-    if (i2c.send(LCR, &lcrValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (LCR) Error\n";
-        return -1;
-    }
-#endif
-    
     config.fifoEnable = value;
     return 1;
 }
@@ -765,25 +1300,18 @@ int gnublin_module_sc16is7x0::enableFifo(int value) {
  * @return -1 on error and 1 on success.
  */
 int gnublin_module_sc16is7x0::rxFifoSetTriggerLevel(unsigned int level) {
-    
+
     //printf("rxFifoSetTriggerLevel(level=%d)\n", level);
 
     errorFlag = false;
-    unsigned char txValue;
-    unsigned char lcrValue;
-    unsigned char efrValue;
-#if (USE_ENHANCED_FIFO)
-    unsigned char tlrValue;
-#else
-    unsigned char mcrValue;
-#endif
-    
+    unsigned char fcrValue;
+
     if (config.fifoEnable == 0) {
         return 1;
     }
 
 #if (USE_ENHANCED_FIFO)
-    if ((level < 4) && (level > 60)) {
+    if ((level < 4) || (level > 60)) {
         errorFlag = true;
         errorMessage = "Level is not between 4 and 60\n";
         return -1;
@@ -808,126 +1336,40 @@ int gnublin_module_sc16is7x0::rxFifoSetTriggerLevel(unsigned int level) {
        FCR[7:6] (RX trigger) can be accessed without restrictions.
        EFR can only by accessed when LCR is 0xBF. */
 
-    if (i2c.receive(LCR, &lcrValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.receive (LCR) Error\n";
-        return -1;
-    }
-
-    /* Set LCR to 0xBF to enable access to EFR register. */
-    txValue = 0xbf;
-    if (i2c.send(LCR, &txValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (EFR) Error\n";
-        return -1;
-    }
-
-    if (i2c.receive(EFR, &efrValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.receive (EFR) Error\n";
-        return -1;
-    }
-
-    /* Set EFR[4]. */
-    txValue = efrValue | (1 << 4);
-    if (i2c.send(EFR, &txValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (EFR) Error\n";
-        return -1;
-    }
-
 #if (USE_ENHANCED_FIFO)
     /* Set the level. */
-    if (i2c.receive(TLR, &tlrValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.receive (TLR) Error\n";
-        return -1;
-    }
-
-    txValue = (tlrValue & 0x0f) | ((level / 4) << 4);
-    if (i2c.send(TLR, &txValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (TLR) Error\n";
+    if (updateTcrTlr(TLR, &config.tlrRegister, (config.tlrRegister & 0x0f) | ((level / 4) << 4), "TLR") < 0) {
         return -1;
     }
 
-    config.fcrRegister &= (UART_RX_FIFO_CLEAR & UART_TX_FIFO_CLEAR);
-    if (i2c.send(FCR, &config.fcrRegister, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (FCR) Error\n";
-        return -1;
-    }
-    
+    fcrValue = config.fcrRegister & (UART_RX_FIFO_CLEAR & UART_TX_FIFO_CLEAR);
 #else
-    config.fcrRegister &= UART_RX_FIFO_CLEAR;
+    fcrValue = config.fcrRegister & UART_RX_FIFO_CLEAR;
     switch (level) {
     case 8 :
-        config.fcrRegister |= UART_RX_FIFO_8;
+        fcrValue |= UART_RX_FIFO_8;
         break;
     case 16 :
-        config.fcrRegister |= UART_RX_FIFO_16;
+        fcrValue |= UART_RX_FIFO_16;
         break;
     case 56 :
-        config.fcrRegister |= UART_RX_FIFO_56;
+        fcrValue |= UART_RX_FIFO_56;
         break;
     case 60 :
-        config.fcrRegister |= UART_RX_FIFO_60;
+        fcrValue |= UART_RX_FIFO_60;
         break;
     default :
-        config.fcrRegister |= UART_RX_FIFO_8;
+        fcrValue |= UART_RX_FIFO_8;
         break;
     }
-    if (i2c.send(FCR, &config.fcrRegister, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (FCR) Error\n";
-        return -1;
-    }
-
-    if (i2c.receive(MCR, &mcrValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.receive (MCR) Error\n";
-        return -1;
-    }
-
-    /* Set MCR[2]. */
-    txValue = mcrValue | (1 << 2);
-    if (i2c.send(EFR, &txValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (MCR) Error\n";
-        return -1;
-    }
-
-    /* Reset the TLR. */
-    txValue = 0x00;
-    if (i2c.send(TLR, &txValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (TLR) Error\n";
-        return -1;
-    }
 
-    /* Restore the MCR register. */
-    if (i2c.send(MCR, &mcrValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (MCR) Error\n";
+    /* The FCR trigger levels are only used when TLR is 0. */
+    if (updateTcrTlr(TLR, &config.tlrRegister, 0x00, "TLR") < 0) {
         return -1;
     }
 #endif
 
-    /* Restore the EFR register. */
-    if (i2c.send(EFR, &efrValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (EFR) Error\n";
-        return -1;
-    }
-
-    /* Restore the LCR register. */
-    if (i2c.send(LCR, &lcrValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (LCR) Error\n";
-        return -1;
-    }
-
-    return 1;
+    return updateRegister(FCR, &config.fcrRegister, fcrValue, "FCR");
 }
 
 
@@ -940,25 +1382,18 @@ int gnublin_module_sc16is7x0::rxFifoSetTriggerLevel(unsigned int level) {
  * @return -1 on error and 1 on success.
  */
 int gnublin_module_sc16is7x0::txFifoSetTriggerLevel(unsigned int level) {
-    
+
     //printf("txFifoSetTriggerLevel(level=%d)\n", level);
 
     errorFlag = false;
-    unsigned char txValue;
-    unsigned char lcrValue;
-    unsigned char efrValue;
-#if (USE_ENHANCED_FIFO)
-    unsigned char tlrValue;
-#else
-    unsigned char mcrValue;
-#endif
+    unsigned char fcrValue;
 
     if (config.fifoEnable == 0) {
         return 1;
     }
 
 #if (USE_ENHANCED_FIFO)
-    if ((level < 4) && (level > 60)) {
+    if ((level < 4) || (level > 60)) {
         errorFlag = true;
         errorMessage = "Level is not between 4 and 60\n";
         return -1;
@@ -970,7 +1405,7 @@ int gnublin_module_sc16is7x0::txFifoSetTriggerLevel(unsigned int level) {
         return -1;
     }
 #else
-    
+
     if ((level != 8) && (level != 16) && (level != 32) && (level != 56)) {
         errorFlag = true;
         errorMessage = "Level is not 8, 16, 32 or 56\n";
@@ -983,152 +1418,178 @@ int gnublin_module_sc16is7x0::txFifoSetTriggerLevel(unsigned int level) {
        FCR[7:6] (RX trigger) can be accessed without restrictions.
        EFR can only by accessed when LCR is 0xBF. */
 
-    if (i2c.receive(LCR, &lcrValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.receive (LCR) Error\n";
-        return -1;
-    }
-
-    /* Set LCR to 0xBF to enable access to EFR register. */
-    txValue = 0xbf;
-    if (i2c.send(LCR, &txValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (EFR) Error\n";
-        return -1;
-    }
-
-    if (i2c.receive(EFR, &efrValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.receive (EFR) Error\n";
-        return -1;
-    }
-
-    /* Set EFR[4]. */
-    txValue = efrValue | (1 << 4);
-    if (i2c.send(EFR, &txValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (EFR) Error\n";
-        return -1;
-    }
-
 #if (USE_ENHANCED_FIFO)
     /* Set the level. */
-    if (i2c.receive(TLR, &tlrValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.receive (TLR) Error\n";
-        return -1;
-    }
-
-    txValue = (tlrValue & 0xf0) | (level / 4);
-    if (i2c.send(TLR, &txValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (TLR) Error\n";
+    if (updateTcrTlr(TLR, &config.tlrRegister, (config.tlrRegister & 0xf0) | (level / 4), "TLR") < 0) {
         return -1;
     }
 
-    config.fcrRegister &= (UART_RX_FIFO_CLEAR & UART_TX_FIFO_CLEAR);
-    if (i2c.send(FCR, &config.fcrRegister, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (FCR) Error\n";
+    fcrValue = config.fcrRegister & (UART_RX_FIFO_CLEAR & UART_TX_FIFO_CLEAR);
+#else
+    if (enableEnhancedFunctions() < 0) {
         return -1;
     }
 
-#else
-    config.fcrRegister &= UART_TX_FIFO_CLEAR;
+    fcrValue = config.fcrRegister & UART_TX_FIFO_CLEAR;
     switch (level) {
     case 8 :
-        config.fcrRegister |= UART_TX_FIFO_8;
+        fcrValue |= UART_TX_FIFO_8;
         break;
     case 16 :
-        config.fcrRegister |= UART_TX_FIFO_16;
+        fcrValue |= UART_TX_FIFO_16;
         break;
-    case 56 :
-        config.fcrRegister |= UART_TX_FIFO_32;
+    case 32 :
+        fcrValue |= UART_TX_FIFO_32;
         break;
-    case 60 :
-        config.fcrRegister |= UART_TX_FIFO_56;
+    case 56 :
+        fcrValue |= UART_TX_FIFO_56;
         break;
     default :
-        config.fcrRegister |= UART_TX_FIFO_8;
+        fcrValue |= UART_TX_FIFO_8;
         break;
     }
-    if (i2c.send(FCR, &config.fcrRegister, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (FCR) Error\n";
+
+    /* The FCR trigger levels are only used when TLR is 0. */
+    if (updateTcrTlr(TLR, &config.tlrRegister, 0x00, "TLR") < 0) {
         return -1;
     }
+#endif
 
-    if (i2c.receive(MCR, &mcrValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.receive (MCR) Error\n";
-        return -1;
+    return updateRegister(FCR, &config.fcrRegister, fcrValue, "FCR");
+}
+
+
+/**
+ * @~english
+ * @brief Get the trigger level of the receiver FIFO.
+ *
+ * @return The trigger level (1 when the FIFO is disabled).
+ */
+unsigned int gnublin_module_sc16is7x0::rxFifoGetTriggerLevel(void) {
+
+    static const unsigned int levels[4] = {8, 16, 56, 60};
+
+    if (config.fifoEnable == 0) {
+        return 1;
     }
 
-    /* Set MCR[2]. */
-    txValue = mcrValue | (1 << 2);
-    if (i2c.send(EFR, &txValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (MCR) Error\n";
-        return -1;
+    /* The FCR trigger levels are only used when TLR is 0. */
+    if ((config.tlrRegister & 0xf0) != 0) {
+        return (config.tlrRegister >> 4) * 4;
     }
 
-    /* Reset the TLR. */
-    txValue = 0x00;
-    if (i2c.send(TLR, &txValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (TLR) Error\n";
-        return -1;
+    return levels[config.fcrRegister >> 6];
+}
+
+
+/**
+ * @~english
+ * @brief Get the trigger level of the transmit FIFO.
+ *
+ * @return The trigger level (1 when the FIFO is disabled).
+ */
+unsigned int gnublin_module_sc16is7x0::txFifoGetTriggerLevel(void) {
+
+    static const unsigned int levels[4] = {8, 16, 32, 56};
+
+    if (config.fifoEnable == 0) {
+        return 1;
     }
 
-    /* Restore the MCR register. */
-    if (i2c.send(MCR, &mcrValue, 1) < 0) {
+    /* The FCR trigger levels are only used when TLR is 0. */
+    if ((config.tlrRegister & 0x0f) != 0) {
+        return (config.tlrRegister & 0x0f) * 4;
+    }
+
+    return levels[(config.fcrRegister >> 4) & 0x03];
+}
+
+
+/**
+ * @~english
+ * @brief Enable or disable the adaptive trigger levels. When enabled, the
+ * interrupts per second and the bytes per interrupt are measured by pollInt
+ * over windows of ADAPTIVE_WINDOW ms. At the end of each window the RX and
+ * TX trigger levels (TLR) are set to the lowest levels keeping the number
+ * of interrupts below maxIntRate at the measured throughput. A level is
+ * raised at once and lowered by one step (4 bytes) per window.
+ *
+ * The RX level is bounded by maxLatency, the time to receive the level at
+ * the current baud rate, and by the halt level when the automatic RTS or
+ * XOFF flow control is enabled. The TX level leaves ADAPTIVE_TX_HEADROOM
+ * bytes in the FIFO to cover the interrupt servicing. The FIFO must be
+ * enabled.
+ *
+ * @param value 1 to enable and 0 to disable.
+ * @param maxIntRate The maximum number of interrupts per second.
+ * @param maxLatency The maximum RX latency in us.
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_module_sc16is7x0::setAdaptiveTrigger(int value, unsigned int maxIntRate, unsigned int maxLatency) {
+
+    errorFlag = false;
+
+#if !(USE_ENHANCED_FIFO)
+    if (value == 1) {
         errorFlag = true;
-        errorMessage = "i2c.send (MCR) Error\n";
+        errorMessage = "Adaptive trigger levels need the enhanced FIFO (TLR)\n";
         return -1;
     }
 #endif
-    
-    /* Restore the EFR register. */
-    if (i2c.send(EFR, &efrValue, 1) < 0) {
+
+    if ((value == 1) && (config.fifoEnable == 0)) {
         errorFlag = true;
-        errorMessage = "i2c.send (EFR) Error\n";
+        errorMessage = "FIFO is disabled\n";
         return -1;
     }
 
-    /* Restore the LCR register. */
-    if (i2c.send(LCR, &lcrValue, 1) < 0) {
+    if (maxIntRate == 0) {
         errorFlag = true;
-        errorMessage = "i2c.send (LCR) Error\n";
+        errorMessage = "Interrupt rate is 0\n";
         return -1;
     }
 
+    adaptiveEnable = value;
+    adaptiveRate = maxIntRate;
+    adaptiveLatency = maxLatency;
+
+    /* Start a new window. */
+    clock_gettime(CLOCK_MONOTONIC, &adaptiveStart);
+    adaptiveRxInterrupts = intStats.rxInterrupts;
+    adaptiveRxBytes = intStats.rxBytes;
+    adaptiveTxInterrupts = intStats.txInterrupts;
+    adaptiveTxBytes = intStats.txBytes;
+
     return 1;
 }
 
 
 /**
  * @~english
- * @brief Empty the receive FIFO.
+ * @brief Empty the receive FIFO and the RX ring buffer.
  *
  * @return -1 on error and 1 on success.
  */
 int gnublin_module_sc16is7x0::rxEmptyFifo(void){
 
     errorFlag = false;
-    int available = rxAvailableData();
-    unsigned char buffer[available];
+    char buffer[FIFO_SIZE];
 
-    if (available == 0) {
-        return 1;
-    }
+    rxHead = 0;
+    rxCount = 0;
+    rxScanned = 0;
 
-    if (i2c.receive(RHR, buffer, available) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.receive (RHR) Error\n";
-        return -1;
-    }
+    while (true) {
+        int count = rxBurst(buffer, FIFO_SIZE);
 
-    return 1;
+        if (count < 0) {
+            return -1;
+        }
+
+        if (count == 0) {
+            return 1;
+        }
+    }
 }
 
 
@@ -1145,13 +1606,14 @@ int gnublin_module_sc16is7x0::resetRxFifo(void) {
     unsigned char txValue;
 
     txValue = config.fcrRegister | (1 << 1);
-    if (i2c.send(FCR, &txValue, 1) > 0) {
+    if (transport->send(FCR, &txValue, 1) > 0) {
+        rxLevel = 0;
         usleep(10);
         return 1;
     }
     else {
         errorFlag = true;
-        errorMessage = "i2c.send (FCR) Error\n";
+        errorMessage = "send (FCR) Error\n";
         return -1;
     }
 
@@ -1174,13 +1636,14 @@ int gnublin_module_sc16is7x0::resetTxFifo(void) {
     unsigned char txValue;
 
     txValue = config.fcrRegister | (1 << 2);
-    if (i2c.send(FCR, &txValue, 1) > 0) {
+    if (transport->send(FCR, &txValue, 1) > 0) {
+        txSpace = 0;
         usleep(10);
         return 1;
     }
     else {
         errorFlag = true;
-        errorMessage = "i2c.send (FCR) Error\n";
+        errorMessage = "send (FCR) Error\n";
         return -1;
     }
 
@@ -1192,7 +1655,8 @@ int gnublin_module_sc16is7x0::resetTxFifo(void) {
 
 /**
  * @~english
- * @brief Return the number of bytes available in the RX buffer.
+ * @brief Return the number of bytes available in the RX FIFO and in the RX
+ * ring buffer.
  *
  * @return The available data or -1 on error.
  */
@@ -1201,13 +1665,14 @@ int gnublin_module_sc16is7x0::rxAvailableData(void) {
     errorFlag = false;
     unsigned char rxValue;
 
-    if (i2c.receive(RXLVL, &rxValue, 1) < 0) {
+    if (transport->receive(RXLVL, &rxValue, 1) < 0) {
         errorFlag = true;
-        errorMessage = "i2c.receive (RXLVL) Error\n";
+        errorMessage = "receive (RXLVL) Error\n";
         return -1;
     }
 
-    return rxValue;
+    rxLevel = rxValue;
+    return rxValue + rxCount;
 }
 
 
@@ -1222,12 +1687,13 @@ int gnublin_module_sc16is7x0::txAvailableSpace(void) {
     errorFlag = false;
     unsigned char rxValue;
 
-    if (i2c.receive(TXLVL, &rxValue, 1) < 0) {
+    if (transport->receive(TXLVL, &rxValue, 1) < 0) {
         errorFlag = true;
-        errorMessage = "i2c.receive (TXLVL) Error\n";
+        errorMessage = "receive (TXLVL) Error\n";
         return -1;
     }
 
+    txSpace = rxValue;
     return rxValue;
 }
 
@@ -1243,9 +1709,9 @@ unsigned char gnublin_module_sc16is7x0::readLineStatus(void) {
     errorFlag = false;
     unsigned char rxValue;
 
-    if (i2c.receive(LSR, &rxValue, 1) < 0) {
+    if (transport->receive(LSR, &rxValue, 1) < 0) {
         errorFlag = true;
-        errorMessage = "i2c.receive (LSR) Error\n";
+        errorMessage = "receive (LSR) Error\n";
         return -1;
     }
 
@@ -1255,32 +1721,76 @@ unsigned char gnublin_module_sc16is7x0::readLineStatus(void) {
 
 /**
  * @~english
- * @brief Enable the loopback mode (for test purpose only).
- * The MCR[1:0] signals are looped back int MSR[4:5] and the TX output
- * is looped back to the RX input internally.
+ * @brief Read the modem status (MSR Modem Status Register). The delta bits
+ * are cleared by the read, the modem ISR is called when they are set. The
+ * TX path is parked or resumed according to CTS when the modem interrupts
+ * are enabled.
  *
- * @return -1 on error and 1 on success.
+ * @return The status read from the Modem Status Register or -1 on error.
  */
-int gnublin_module_sc16is7x0::enableLoopback(void) {
+int gnublin_module_sc16is7x0::readModemStatus(void) {
 
     errorFlag = false;
-    unsigned char mcrValue;
-    unsigned char txValue = 0;
+    unsigned char msr;
+    sc16is7x0_xfer xfers[3];
+    unsigned char values[3];
+    int count = 0;
+
+    /* MSR is TCR when MCR[2] and EFR[4] are set. */
+    int tcrTlr = (config.mcrRegister & (1 << 2)) && (config.efrRegister & (1 << 4));
+
+    if (tcrTlr) {
+        planWrite(xfers, values, &count, MCR, config.mcrRegister & ~(1 << 2));
+    }
+    xfers[count].reg = MSR;
+    xfers[count].read = 1;
+    xfers[count].buffer = &msr;
+    xfers[count].len = 1;
+    count++;
+    if (tcrTlr) {
+        planWrite(xfers, values, &count, MCR, config.mcrRegister);
+    }
 
-    if (i2c.receive(MCR, &mcrValue, 1) < 0) {
+    if (transport->transfer(xfers, count) < 0) {
         errorFlag = true;
-        errorMessage = "i2c.receive (MCR) Error\n";
+        errorMessage = "transfer (MSR) Error\n";
         return -1;
     }
 
-    txValue = mcrValue | 0x10;
-    if (i2c.send(MCR, &txValue, 1) < 0) {
-        errorFlag = true;
-        errorMessage = "i2c.send (MCR) Error\n";
+    if (modemUpdate(msr) < 0) {
         return -1;
     }
 
-    return 1;
+    return msr;
+}
+
+
+/**
+ * @~english
+ * @brief Return the state of CTS known from the last modem status read. No
+ * register is read.
+ *
+ * @return 1 when CTS is active and 0 otherwise.
+ */
+int gnublin_module_sc16is7x0::isCtsActive(void) {
+
+    return (modemStatus & MSR_CTS) ? 1 : 0;
+}
+
+
+/**
+ * @~english
+ * @brief Enable the loopback mode (for test purpose only).
+ * The MCR[1:0] signals are looped back int MSR[4:5] and the TX output
+ * is looped back to the RX input internally.
+ *
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_module_sc16is7x0::enableLoopback(void) {
+
+    errorFlag = false;
+
+    return updateRegister(MCR, &config.mcrRegister, config.mcrRegister | 0x10, "MCR");
 }
 
 
@@ -1299,9 +1809,9 @@ int gnublin_module_sc16is7x0::writeByte(const char byte) {
     /* Wait for the THR (Transmit Holding Register) to be empty. */
     /*
     while (true) {
-        if (i2c.receive(LSR, &lsrValue, 1) < 0) {
+        if (transport->receive(LSR, &lsrValue, 1) < 0) {
             errorFlag = true;
-            errorMessage = "i2c.receive (LSR) Error\n";
+            errorMessage = "receive (LSR) Error\n";
             return -1;
         }
 
@@ -1318,7 +1828,7 @@ int gnublin_module_sc16is7x0::writeByte(const char byte) {
         	usleep(10);
     }
 
-    if (i2c.send(THR, (unsigned char *)(&byte), 1) > 0) {
+    if (transport->send(THR, (unsigned char *)(&byte), 1) > 0) {
         return 1;
     }
 
@@ -1331,6 +1841,8 @@ int gnublin_module_sc16is7x0::writeByte(const char byte) {
 /**
  * @~english
  * @brief Write data to the UART. Blocking when no free space in TX FIFO.
+ * When the TX buffer is enabled (see enableTxBuffer), the data is copied in
+ * the TX ring buffer and the call returns immediately.
  *
  * @param buffer The data to write.
  * @param len The number of bytes to write.
@@ -1338,65 +1850,106 @@ int gnublin_module_sc16is7x0::writeByte(const char byte) {
  */
 int gnublin_module_sc16is7x0::write(const char *buffer, unsigned int len) {
 
+    struct iovec iov;
+
+    iov.iov_base = (void *)buffer;
+    iov.iov_len = len;
+
+    return writev(&iov, 1);
+}
+
+
+/**
+ * @~english
+ * @brief Write data segments to the UART (scatter-gather). The segments are
+ * packed in FIFO sized THR bursts, their boundaries do not cost extra
+ * transactions. Blocking when no free space in TX FIFO or while CTS is
+ * inactive (see intIsrModem). When the TX buffer is enabled (see
+ * enableTxBuffer), the segments are copied in the TX ring buffer and the
+ * call returns immediately.
+ *
+ * @param iov The data segments to write.
+ * @param iovcnt The number of segments.
+ * @return -1 on error or the number of bytes written on success.
+ */
+int gnublin_module_sc16is7x0::writev(const struct iovec *iov, int iovcnt) {
+
     errorFlag = false;
-    //unsigned char lsrValue;
-    int available = 0;
-    int len2send = len;
     int writeLen = 0;
     int writeBytes = 0;
+    int index = 0;
+    unsigned int offset = 0;
+
+    if (txBufferEnable == 1) {
+        for (int i = 0; (i < iovcnt) && (txCount < TX_BUFFER_SIZE); i++) {
+            const char *buffer = (const char *)iov[i].iov_base;
+            unsigned int len = iov[i].iov_len;
+            unsigned int room = TX_BUFFER_SIZE - txCount;
+            unsigned int tail = (txHead + txCount) % TX_BUFFER_SIZE;
+
+            if (len > room) {
+                len = room;
+            }
 
-    /* Wait for the THR (Transmit Holding Register) to be empty. */
-    /*
-    while (true) {
-        if (i2c.receive(LSR, &lsrValue, 1) < 0) {
-            errorFlag = true;
-            errorMessage = "i2c.receive (LSR) Error\n";
-            return -1;
+            /* Copy the data in the ring, in two parts when it wraps. */
+            unsigned int part = TX_BUFFER_SIZE - tail;
+            if (part > len) {
+                part = len;
+            }
+            memcpy(txBuffer + tail, buffer, part);
+            memcpy(txBuffer, buffer + part, len - part);
+            txCount += len;
+            writeBytes += len;
         }
 
-        if ((lsrValue & (1 << 5)) != 0) {
-    */
-            /* THR empty. */
-    /*
-            break;
+        /* The THR interrupt refill the FIFO once it is enabled. */
+        if ((config.ierRegister & CONF_INT_THREN) == 0) {
+            if (txRefill() < 0) {
+                return -1;
+            }
         }
 
-        usleep(10);
+        return writeBytes;
     }
-    */
 
-    while (len2send > 0) {
+    while (true) {
 
-        while ((available = (int)txAvailableSpace()) == 0 ) {
-            /* Wait for space in TX FIFO */
-            usleep(10);
+        /* Skip the segments written. */
+        while ((index < iovcnt) && (offset >= iov[index].iov_len)) {
+            offset -= iov[index].iov_len;
+            index++;
         }
-
-        if (len2send > available) {
-            writeLen = available;
+        if (index == iovcnt) {
+            break;
         }
-        else {
-            writeLen = len2send;
+
+        if (txParked) {
+            /* CTS inactive, wait for the modem interrupt. */
+            if (txParkWait() < 0) {
+                return -1;
+            }
+            continue;
         }
 
         if (config.fifoEnable == 1) {
-            if (i2c.send(THR, (unsigned char *)buffer, writeLen) < 0) {
-                errorFlag = true;
-                errorMessage = "i2c.send (THR) Error\n";
+            if ((writeLen = txBurst(iov + index, iovcnt - index, offset)) < 0) {
                 return -1;
             }
+
+            if (writeLen == 0) {
+                /* Wait for space in TX FIFO */
+                usleep(10);
+                continue;
+            }
         }
         else {
-            int writeCount = 0;
-            while (writeCount <= writeLen) {
-                if (writeByte(buffer[writeCount]) < 0) {
-                }
-                writeCount++;
+            if (writeByte(((const char *)iov[index].iov_base)[offset]) < 0) {
+                return -1;
             }
+            writeLen = 1;
         }
 
-        len2send -= writeLen;
-        buffer += writeLen;
+        offset += writeLen;
         writeBytes += writeLen;
     }
 
@@ -1404,66 +1957,515 @@ int gnublin_module_sc16is7x0::write(const char *buffer, unsigned int len) {
 }
 
 
+/**
+ * @~english
+ * @brief Enable or disable the TX ring buffer. When enabled, write copies
+ * the data in a ring buffer of TX_BUFFER_SIZE bytes and returns without
+ * waiting. The TX FIFO is refilled on THR interrupts by pollInt. The THR
+ * interrupt is enabled as long as data is waiting in the ring buffer.
+ * The data still waiting is discarded when the buffer is disabled.
+ *
+ * @param value 1 to enable and 0 to disable.
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_module_sc16is7x0::enableTxBuffer(int value) {
+
+    errorFlag = false;
+
+    txHead = 0;
+    txCount = 0;
+    txBufferEnable = value;
+
+    return enableTxInterrupt(0);
+}
+
+
+/**
+ * @~english
+ * @brief Return the number of bytes waiting in the TX ring buffer.
+ *
+ * @return The number of bytes waiting to be written in the TX FIFO.
+ */
+int gnublin_module_sc16is7x0::txBufferedData(void) {
+
+    return txCount;
+}
+
+
+/**
+ * @~english
+ * @brief Wait until all the data of the TX ring buffer has been written in
+ * the TX FIFO. The call blocks on the IRQ line (see setIrqSource) and services
+ * the interrupts until the ring buffer is empty.
+ *
+ * @param timeout The timeout in milliseconds, -1 to wait forever.
+ * @return -1 on error, 0 on timeout and 1 when the ring buffer is empty.
+ */
+int gnublin_module_sc16is7x0::flush(int timeout) {
+
+    errorFlag = false;
+    struct timespec deadline;
+    int ret;
+
+    if (txCount == 0) {
+        return 1;
+    }
+
+    if (irqSource == NULL) {
+        errorFlag = true;
+        errorMessage = "No IRQ source set\n";
+        return -1;
+    }
+
+    if (timeout >= 0) {
+        deadlineSet(&deadline, timeout);
+    }
+
+    while (true) {
+
+        /* Service the pending interrupts. The IRQ line stays active otherwise
+           and no edge is detected. */
+        for (int i = 0; i < IRQ_MAX_SERVICE; i++) {
+            if ((ret = pollInt()) <= 0) {
+                break;
+            }
+        }
+        if (ret < 0) {
+            return -1;
+        }
+
+        if (txCount == 0) {
+            return 1;
+        }
+
+        if ((ret = waitInt(timeout >= 0 ? deadlineLeft(&deadline) : -1)) <= 0) {
+            return ret;
+        }
+    }
+}
+
+
+/**
+ * @~english
+ * @brief Wait until the transmission is complete, the TX FIFO and the TSR
+ * are empty (LSR[6]). The TX ring buffer is flushed first (see flush). The
+ * time needed to transmit the bytes in the TX FIFO is slept at once from
+ * the baud rate and the data format, the LSR is then polled every quarter
+ * of a character time. When the baud rate is unknown (see syncConfig), the
+ * LSR is polled every character time at the slowest baud rate (UART_300).
+ * In RS-485 mode, the driver is disabled when this returns.
+ *
+ * @param timeout The timeout in milliseconds, -1 for infinite.
+ * @return -1 on error, 0 on timeout and 1 on success.
+ */
+int gnublin_module_sc16is7x0::waitTxComplete(int timeout) {
+
+    errorFlag = false;
+    struct timespec deadline;
+    unsigned char lsr;
+    unsigned char level;
+    sc16is7x0_xfer xfers[2];
+    unsigned long charTime = 0;
+    unsigned long pollTime;
+    int ret;
+
+    if (timeout >= 0) {
+        deadlineSet(&deadline, timeout);
+    }
+
+    if (txCount > 0) {
+        if ((ret = flush((timeout >= 0) ? deadlineLeft(&deadline) : -1)) <= 0) {
+            return ret;
+        }
+    }
+
+    /* Time of a character in us : start, data, parity and stop bits. */
+    unsigned int bits = 1 + 5 + (config.lcrRegister & 0x03) + ((config.lcrRegister & 0x08) ? 1 : 0) + ((config.lcrRegister & 0x04) ? 2 : 1);
+    if (config.baudRate > 0) {
+        charTime = (bits * 1000000UL + config.baudRate - 1) / config.baudRate;
+        pollTime = (charTime > 40) ? charTime / 4 : 10;
+    }
+    else {
+        pollTime = (bits * 1000000UL + UART_300 - 1) / UART_300;
+    }
+
+    xfers[0].reg = LSR;
+    xfers[0].read = 1;
+    xfers[0].buffer = &lsr;
+    xfers[0].len = 1;
+    xfers[1].reg = TXLVL;
+    xfers[1].read = 1;
+    xfers[1].buffer = &level;
+    xfers[1].len = 1;
+
+    while (true) {
+        if (transport->transfer(xfers, 2) < 0) {
+            errorFlag = true;
+            errorMessage = "transfer (LSR/TXLVL) Error\n";
+            return -1;
+        }
+        txSpace = level;
+
+        if (lsr & LSR_TX_EMPTY) {
+            return 1;
+        }
+
+        if ((timeout >= 0) && (deadlineLeft(&deadline) == 0)) {
+            return 0;
+        }
+
+        /* The bytes in the FIFO, the one in the TSR is partly sent. */
+        unsigned long wait = (FIFO_SIZE - level) * charTime;
+        if (wait == 0) {
+            wait = pollTime;
+        }
+        if ((timeout >= 0) && (wait > (unsigned long)deadlineLeft(&deadline) * 1000)) {
+            wait = deadlineLeft(&deadline) * 1000;
+        }
+        usleep(wait);
+    }
+}
+
+
 /**
  * @~english
  * @brief Read a byte from the UART.
  *
  * @param byte The byte read.
- * @return -1 on error and 1 on success.
+ * @return -1 on error, 0 when no byte is available and 1 on success.
  */
 int gnublin_module_sc16is7x0::readByte(char *byte) {
 
     errorFlag = false;
-    int available = rxAvailableData();
 
-    if (available < 0) {
-        byte = NULL;
+    return read(byte, 1);
+}
+
+
+/**
+ * @~english
+ * @brief Read data from the UART. The data waiting in the RX ring buffer is
+ * read first, then the RX FIFO is drained until it is empty or the buffer is
+ * full.
+ *
+ * @param buffer The data read.
+ * @param len The number of bytes to read.
+ * @param errors The error flags (LSR[4:2]) of the bytes read or NULL. The
+ * flags are only known for the bytes read in the RX ring buffer on the
+ * receiver line status interrupt (see setRxErrorBuffer).
+ * @return -1 on error and the number of bytes read on success.
+ */
+int gnublin_module_sc16is7x0::read(char *buffer, unsigned int len, unsigned char *errors) {
+
+    errorFlag = false;
+    unsigned int count = 0;
+
+    while ((rxCount > 0) && (count < len)) {
+        unsigned int part = rxSize - rxHead;
+        if (part > rxCount) {
+            part = rxCount;
+        }
+        if (part > len - count) {
+            part = len - count;
+        }
+
+        memcpy(buffer + count, rxData + rxHead, part);
+        if (errors != NULL) {
+            if (rxErrors != NULL) {
+                memcpy(errors + count, rxErrors + rxHead, part);
+            }
+            else {
+                memset(errors + count, 0, part);
+            }
+        }
+        rxHead = (rxHead + part) % rxSize;
+        rxCount -= part;
+        count += part;
+    }
+    rxScanned = 0;
+
+    if (count < len) {
+        int readLen = rxBurst(buffer + count, len - count);
+        if (readLen < 0) {
+            return -1;
+        }
+        if (errors != NULL) {
+            memset(errors + count, 0, readLen);
+        }
+        count += readLen;
+    }
+
+    return count;
+}
+
+
+/**
+ * @~english
+ * @brief Set the buffer used as RX ring buffer. The RX FIFO is drained in
+ * this buffer on RHR interrupts. The internal buffer of RX_BUFFER_SIZE bytes
+ * is used when no buffer is given. The data waiting in the current ring
+ * buffer is discarded. The error buffer is disabled when smaller than the
+ * new ring buffer.
+ *
+ * @param buffer The buffer to use or NULL to use the internal buffer.
+ * @param size The size of the buffer.
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_module_sc16is7x0::setRxBuffer(char *buffer, unsigned int size) {
+
+    errorFlag = false;
+
+    if ((buffer != NULL) && (size == 0)) {
+        errorFlag = true;
+        errorMessage = "Buffer size is 0\n";
         return -1;
     }
 
-    if (available == 0) {
-        byte = NULL;
-        return 1;
+    if (buffer == NULL) {
+        rxData = rxBuffer;
+        rxSize = RX_BUFFER_SIZE;
+    }
+    else {
+        rxData = buffer;
+        rxSize = size;
+    }
+
+    if (rxErrorsSize < rxSize) {
+        rxErrors = NULL;
+        rxErrorsSize = 0;
     }
 
-    if (i2c.receive(RHR, (unsigned char *)byte, 1) < 0) {
+    rxHead = 0;
+    rxCount = 0;
+    rxScanned = 0;
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Set the buffer keeping the error flags (LSR[4:2]) of the bytes of
+ * the RX ring buffer. The flag of a byte is at the same index as the byte
+ * in the ring buffer. The flags are set on the receiver line status
+ * interrupt (see CONF_INT_RLSEN), the bytes read on the other interrupts
+ * are flagged without error.
+ *
+ * @param buffer The buffer for the flags or NULL to disable them.
+ * @param size The size of the buffer, at least the size of the RX ring
+ * buffer.
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_module_sc16is7x0::setRxErrorBuffer(unsigned char *buffer, unsigned int size) {
+
+    errorFlag = false;
+
+    if ((buffer != NULL) && (size < rxSize)) {
         errorFlag = true;
-        errorMessage = "i2c.receive (RHR) Error\n";
+        errorMessage = "Error buffer smaller than the RX buffer\n";
         return -1;
     }
 
+    rxErrors = buffer;
+    rxErrorsSize = (buffer != NULL) ? size : 0;
+    if (rxErrors != NULL) {
+        memset(rxErrors, 0, rxSize);
+    }
+
     return 1;
 }
 
 
 /**
  * @~english
- * @brief Read data from the UART.
+ * @brief Get the error flags of a view in the RX ring buffer (given to the
+ * data received ISR or returned by readUntil).
+ *
+ * @param data The view in the ring buffer.
+ * @return The error flags of the bytes of the view or NULL when the error
+ * buffer is not set or the data is not in the ring buffer.
+ */
+const unsigned char *gnublin_module_sc16is7x0::getRxErrors(const char *data) {
+
+    if ((rxErrors == NULL) || (data < rxData) || (data >= rxData + rxSize)) {
+        return NULL;
+    }
+
+    return rxErrors + (data - rxData);
+}
+
+
+/**
+ * @~english
+ * @brief Read data from the UART, waiting for it. The IRQ is waited for
+ * until at least one byte is received, the data available is then
+ * returned. The thread sleeps while waiting. The IRQ source must be set and
+ * the RHR interrupt enabled (the data below the trigger level is received
+ * on the RX timeout interrupt). The data received ISR must not be
+ * registered.
+ *
+ * @param buffer The data read.
+ * @param len The size of the buffer.
+ * @param timeout The timeout in milliseconds, 0 to return at once and -1 to
+ * wait forever.
+ * @return -1 on error, 0 on timeout and the number of bytes read on
+ * success.
+ */
+int gnublin_module_sc16is7x0::readTimeout(char *buffer, unsigned int len, int timeout) {
+
+    return readWait(buffer, len, 1, timeout);
+}
+
+
+/**
+ * @~english
+ * @brief Read the given number of bytes from the UART, waiting for them as
+ * readTimeout does. The data received before the timeout is returned.
  *
  * @param buffer The data read.
  * @param len The number of bytes to read.
- * @return -1 on error and the number of bytes read on success.
+ * @param timeout The timeout in milliseconds, 0 to return at once and -1 to
+ * wait forever.
+ * @return -1 on error and the number of bytes read on success, less than
+ * len on timeout.
+ */
+int gnublin_module_sc16is7x0::readExact(char *buffer, unsigned int len, int timeout) {
+
+    return readWait(buffer, len, len, timeout);
+}
+
+
+/**
+ * @~english
+ * @brief Read data from the UART up to the given delimiter. The RX ring
+ * buffer is searched for the delimiter, the RX FIFO is drained in the ring
+ * buffer when it is not found. No data is copied, a view in the ring buffer
+ * is returned. The data is moved in the ring buffer only when the view
+ * wraps around its end. The ring buffer content is returned when it is full
+ * and does not contain the delimiter.
+ *
+ * When a timeout is given, the IRQ is waited for until the delimiter is
+ * received. The IRQ source must be set and the RHR interrupt enabled, or
+ * the XOFF interrupt with the special character (see setSpecialChar). The
+ * data received ISR must not be registered, the data is not kept in the
+ * ring buffer otherwise.
+ *
+ * @param delim The delimiter.
+ * @param data The view of the data read, delimiter included. It is valid
+ * until the next read or interrupt servicing.
+ * @param timeout The timeout in milliseconds, 0 to return at once and -1 to
+ * wait forever.
+ * @return -1 on error, 0 when the delimiter is not received and the number
+ * of bytes read on success.
  */
-int gnublin_module_sc16is7x0::read(char *buffer, unsigned int len) {
+int gnublin_module_sc16is7x0::readUntil(char delim, const char **data, int timeout) {
 
     errorFlag = false;
-    unsigned int available = rxAvailableData();
-    int readBytes = 0;
-    unsigned int len2read = len;
+    struct timespec deadline;
+    int len;
+    int ret = 0;
 
-    if (len2read > available) {
-        len2read = available;
+    if (rxWaitCheck(timeout) < 0) {
+        return -1;
+    }
+
+    if (timeout > 0) {
+        deadlineSet(&deadline, timeout);
+    }
+
+    for (int pass = 0; ; pass++) {
+
+        if ((len = rxScan(delim)) > 0) {
+            break;
+        }
+
+        if (rxCount == rxSize) {
+            len = rxCount;
+            break;
+        }
+
+        if (pass > 0) {
+            if (timeout == 0) {
+                return 0;
+            }
+
+            if ((ret = rxWaitInt(&deadline, timeout)) <= 0) {
+                return ret;
+            }
+        }
+
+        rxEdgeTime(pass > 0);
+        if (rxFill() < 0) {
+            return -1;
+        }
+
+        /* Service the pending interrupts. The IRQ line stays active otherwise
+           and no edge is detected. */
+        if (timeout != 0) {
+            for (int i = 0; i < IRQ_MAX_SERVICE; i++) {
+                if ((ret = pollInt()) <= 0) {
+                    break;
+                }
+            }
+            if (ret < 0) {
+                return -1;
+            }
+        }
+    }
+
+    /* Make the view contiguous. */
+    if (rxHead + len > rxSize) {
+        std::rotate(rxData, rxData + rxHead, rxData + rxSize);
+        if (rxErrors != NULL) {
+            std::rotate(rxErrors, rxErrors + rxHead, rxErrors + rxSize);
+        }
+        rxHead = 0;
+    }
+
+    *data = rxData + rxHead;
+    rxHead = (rxHead + len) % rxSize;
+    rxCount -= len;
+    rxScanned = 0;
+
+    return len;
+}
+
+
+/**
+ * @~english
+ * @brief Read a line terminated by LF from the UART (see readUntil). The LF
+ * and a preceding CR are replaced by NUL in the ring buffer, the view is a
+ * c-string. A line longer than the ring buffer is discarded.
+ *
+ * @param line The view of the line read.
+ * @param timeout The timeout in milliseconds, 0 to return at once and -1 to
+ * wait forever.
+ * @return -1 on error, 0 when no complete line is received and the number
+ * of bytes read (terminator included) on success.
+ */
+int gnublin_module_sc16is7x0::readLine(const char **line, int timeout) {
+
+    const char *data;
+    int len;
+
+    if ((len = readUntil('\n', &data, timeout)) <= 0) {
+        return len;
     }
 
-    if (i2c.receive(RHR, (unsigned char *)buffer, len2read) < 0) {
+    if (data[len - 1] != '\n') {
         errorFlag = true;
-        errorMessage = "i2c.receive (RHR) Error\n";
+        errorMessage = "Line is longer than the RX buffer\n";
         return -1;
     }
 
-    readBytes += len2read;
+    /* The view is in the ring buffer, the terminator is not used anymore. */
+    char *end = (char *)data + len - 1;
+    *end = '\0';
+    if ((end > data) && (*(end - 1) == '\r')) {
+        *(end - 1) = '\0';
+    }
 
-    return readBytes;
+    *line = data;
+    return len;
 }
 
 
@@ -1478,7 +2480,7 @@ int gnublin_module_sc16is7x0::isIntPending(void) {
     errorFlag = false;
     unsigned char rxValue;
 
-    if (i2c.receive(IIR, &rxValue, 1) > 0) {
+    if (transport->receive(IIR, &rxValue, 1) > 0) {
 
         if ((rxValue & 0x01) == 1) {
             /* No interrupt pending. */
@@ -1497,7 +2499,7 @@ int gnublin_module_sc16is7x0::isIntPending(void) {
     
     else {
         errorFlag = true;
-        errorMessage = "i2c.receive (IIR) Error\n";
+        errorMessage = "receive (IIR) Error\n";
         return -1;
     }
 
@@ -1509,7 +2511,8 @@ int gnublin_module_sc16is7x0::isIntPending(void) {
 
 /**
  * @~english
- * @brief Identifies the pending interrupt.
+ * @brief Identifies the pending interrupt. The modem interrupt (INT_MODEM)
+ * is 0 as when no interrupt is pending, pollInt tells them apart.
  *
  * @return The pending interrupt, 0 when no interrupt pending or -1 on error.
  */
@@ -1518,9 +2521,9 @@ int gnublin_module_sc16is7x0::whichInt(void) {
     errorFlag = false;
     unsigned char rxValue;
 
-    if (i2c.receive(IIR, &rxValue, 1) < 0) {
+    if (transport->receive(IIR, &rxValue, 1) < 0) {
         errorFlag = true;
-        errorMessage = "i2c.receive (IIR) Error\n";
+        errorMessage = "receive (IIR) Error\n";
         return -1;
     }
 
@@ -1534,6 +2537,34 @@ int gnublin_module_sc16is7x0::whichInt(void) {
 }
 
 
+/**
+ * @~english
+ * @brief Wait for an edge on the IRQ line. The source of the edges is set
+ * with setIrqSource or by a gnublin_irq_reactor.
+ *
+ * @param timeout The timeout in milliseconds, -1 to wait forever.
+ * @return -1 on error, 0 on timeout and 1 when an edge is detected.
+ */
+int gnublin_module_sc16is7x0::waitInt(int timeout) {
+
+    errorFlag = false;
+    int ret;
+
+    if (irqSource == NULL) {
+        errorFlag = true;
+        errorMessage = "No IRQ source set\n";
+        return -1;
+    }
+
+    if ((ret = irqSource->wait(timeout)) < 0) {
+        errorFlag = true;
+        errorMessage = irqSource->getErrorMessage();
+    }
+
+    return ret;
+}
+
+
 /**
  * @~english
  * @brief Poll for an interrupt. It call the appropriate ISR callbacks when
@@ -1544,38 +2575,185 @@ int gnublin_module_sc16is7x0::whichInt(void) {
 int gnublin_module_sc16is7x0::pollInt(void) {
 
     errorFlag = false;
+    unsigned char iir;
+    unsigned char level;
+    sc16is7x0_xfer xfers[2];
+    int count;
+    int ret;
+
+    if (rxPolling == 1) {
+        /* The RX FIFO is polled with the IIR in a single transaction. */
+        xfers[0].reg = IIR;
+        xfers[0].read = 1;
+        xfers[0].buffer = &iir;
+        xfers[0].len = 1;
+        xfers[1].reg = RXLVL;
+        xfers[1].read = 1;
+        xfers[1].buffer = &level;
+        xfers[1].len = 1;
+
+        if (transport->transfer(xfers, 2) < 0) {
+            errorFlag = true;
+            errorMessage = "transfer (IIR/RXLVL) Error\n";
+            return -1;
+        }
+        rxLevel = level;
 
-    int count = 0;
-    int interrupt = whichInt();
-
-    if (interrupt == 0) {
-        /* No pending interrupt. */
-        return interrupt;
+        if ((count = serviceIIR(iir)) < 0) {
+            return -1;
+        }
+        if ((ret = rxPollService()) < 0) {
+            return -1;
+        }
+        return count + ret;
+    }
+
+    /* The IIR is given as is, the modem interrupt (INT_MODEM) is 0 and could
+       not be told apart from no interrupt after whichInt. */
+    if (transport->receive(IIR, &iir, 1) < 0) {
+        errorFlag = true;
+        errorMessage = "receive (IIR) Error\n";
+        return -1;
+    }
+
+    return serviceIIR(iir);
+}
+
+
+/**
+ * @~english
+ * @brief Service the interrupt identified by the given IIR value. The IIR
+ * is read by the caller, with the IIR of other chips for instance (see
+ * sc16is7x0_scheduler).
+ *
+ * @param iir The value of the IIR register.
+ * @return The number of interrupts or -1 on error.
+ */
+int gnublin_module_sc16is7x0::serviceIIR(unsigned char iir) {
+
+    errorFlag = false;
+    serviceMore = 0;
+
+    if ((iir & 0x01) == 1) {
+        /* No pending interrupt. */
+        return 0;
+    }
+
+    int count = serviceInt(iir & 0x3e);
+
+    if ((count >= 0) && (adaptiveEnable == 1)) {
+        if (adaptTrigger() < 0) {
+            return -1;
+        }
     }
-    if (interrupt < 0) {
-        /* Error while identifying interrupt. */
-        return interrupt;
+    else if (count >= 0) {
+        updateIntRates();
     }
 
+    return count;
+}
+
+
+/**
+ * @~english
+ * @brief Set the maximum number of bytes read from the RX FIFO and written
+ * to the TX FIFO per interrupt. The interrupt stays pending when the budget
+ * is exhausted, it is serviced on the next call to pollInt. The poll
+ * timeout is then 0 (see getPollTimeout) so that the reactor calls pollInt
+ * again without waiting for an edge, the IRQ line is still active. This
+ * allows to share the servicing between several chips.
+ *
+ * @param bytes The budget, 0 for no limit.
+ * @return 1.
+ */
+int gnublin_module_sc16is7x0::setServiceBudget(unsigned int bytes) {
+
+    serviceBudget = bytes;
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Service the given interrupt. It call the appropriate ISR callbacks.
+ *
+ * @param interrupt The pending interrupt (see whichInt).
+ * @return The number of interrupts or -1 on error.
+ */
+int gnublin_module_sc16is7x0::serviceInt(int interrupt) {
+
+    int count = 0;
+    int ret;
+
     switch (interrupt) {
     case INT_RLSE :  /* Receiver line status error. */
-        //break;
+        /* Cleared by reading LSR, the remaining data is reported by the
+           RHR or RX timeout interrupt. */
+        rxEdgeTime(irqSource != NULL);
+        if ((ret = rxLineStatus()) < 0) {
+            return -1;
+        }
+        intStats.rxInterrupts++;
+        intStats.rxBytes += ret;
+        count++;
+        break;
     case INT_RTOUT :  /* Receiver timeout. */
         //break;
     case INT_RHR :  /* RHR. */
-        if (isrDataReceived != NULL) {
-            int available = rxAvailableData();
-            if (available > 0) {
-                char *buffer = (char *)malloc(available + 1);
-                read(buffer, available);
-                buffer[available] = '\0';
-                
-                isrDataReceived(buffer, available + 1);
+        /* At least the trigger level of bytes (one byte on timeout) is
+           available, the first burst reads RXLVL with the data. */
+        if (interrupt == INT_RHR) {
+            if ((config.fifoEnable == 1) && (rxLevel < (int)rxFifoGetTriggerLevel())) {
+                rxLevel = rxFifoGetTriggerLevel();
             }
         }
+        if (rxLevel == 0) {
+            rxLevel = 1;
+        }
+
+        /* In framing mode, a byte is kept in the FIFO on RHR interrupts so
+           that the RX timeout interrupt is raised at the end of the frame. */
+        rxKeep = ((rxFraming == 1) && (interrupt == INT_RHR)) ? 1 : 0;
+
+        rxEdgeTime(irqSource != NULL);
+        ret = rxFill();
+        rxKeep = 0;
+        if (ret < 0) {
+            return -1;
+        }
+        intStats.rxInterrupts++;
+        intStats.rxBytes += ret;
         count++;
+
+        /* The trigger level is reached : a burst, the next data is polled
+           with the RHR interrupt disabled. */
+        if ((rxPollEnable == 1) && (interrupt == INT_RHR)) {
+            if (updateRegister(IER, &config.ierRegister, config.ierRegister & ~CONF_INT_RHREN, "IER") < 0) {
+                return -1;
+            }
+            rxPolling = 1;
+            rxPollEmpty = 0;
+        }
+
+        if ((interrupt == INT_RTOUT) && (isrRxTimeout != NULL)) {
+            isrRxTimeout(isrRxTimeoutContext);
+        }
         break;
     case INT_THR :  /* THR. */
+        intStats.txInterrupts++;
+        if (txBufferEnable == 1) {
+            unsigned int waiting = txCount;
+
+            /* At least the trigger level of spaces is available. */
+            if ((config.fifoEnable == 1) && (txSpace < (config.tlrRegister & 0x0f) * 4)) {
+                txSpace = (config.tlrRegister & 0x0f) * 4;
+            }
+
+            if (txRefill() < 0) {
+                return -1;
+            }
+            intStats.txBytes += waiting - txCount;
+        }
         if (isrSpaceAvailable != NULL) {
             int available = txAvailableSpace();
             isrSpaceAvailable(available);
@@ -1583,10 +2761,31 @@ int gnublin_module_sc16is7x0::pollInt(void) {
         count++;
         break;
     case INT_MODEM :  /* Modem. */
+        /* Cleared by reading MSR. */
+    case INT_CTSRTS :  /* CTS, RTS change of state from active (LOW) to inactive (HIGH). */
+        /* Cleared by reading IIR, the MSR gives the state of CTS. */
+        if (readModemStatus() < 0) {
+            return -1;
+        }
+        count++;
         break;
     case INT_XOFF :  /* Received Xoff signal / special character. */
-        break;
-    case INT_CTSRTS :  /* CTS, RTS change of state from active (LOW) to inactive (HIGH). */
+        /* Cleared by reading IIR. The RX FIFO is drained up to the special
+           character so that the frame is delivered with a single wakeup.
+           RXLVL is read first, the FIFO may have been drained since the
+           interrupt (see readUntil). */
+        if (getSpecialChar() != SPECIAL_CHAR_NONE) {
+            rxEdgeTime(irqSource != NULL);
+            if ((ret = rxFill()) < 0) {
+                return -1;
+            }
+            intStats.rxInterrupts++;
+            intStats.rxBytes += ret;
+        }
+        if (isrXoff != NULL) {
+            isrXoff(isrXoffContext);
+        }
+        count++;
         break;
     default :
         errorFlag = true;
@@ -1604,14 +2803,17 @@ int gnublin_module_sc16is7x0::pollInt(void) {
  * @brief Register an Interrupt Service Routine that will be called when
  * data is received. It is called when the RX trigger level is reached.
  *
- * @param isr Callback function that will be called on interrupt. This is the
- * responsibility of the ISR to freed the buffer allocated memory.
+ * @param isr Callback function that will be called on interrupt. The buffer
+ * is a view in the RX ring buffer, it is only valid during the call. The
+ * data is removed from the ring buffer when the ISR returns.
+ * @param context The context given to the ISR.
  *
- * isr(char *, int)
+ * isr(const char *buffer, int len, void *context)
  */
-int gnublin_module_sc16is7x0::intIsrDataReceived(void (*isr)(char *, int)) {
+int gnublin_module_sc16is7x0::intIsrDataReceived(void (*isr)(const char *, int, void *), void *context) {
 
     isrDataReceived = isr;
+    isrDataReceivedContext = context;
     return 1;
 }
 
@@ -1631,6 +2833,1522 @@ int gnublin_module_sc16is7x0::intIsrSpaceAvailable(void (*isr)(int)) {
     return 1;
 }
 
+
+/**
+ * @~english
+ * @brief Register an Interrupt Service Routine that will be called when
+ * a XOFF character is received (see setFlowControl). The XOFF interrupt
+ * must be enabled (CONF_INT_XOFFEN). With the special character detection
+ * (see setSpecialChar), it is called when the special character is
+ * received, after the data up to it is delivered.
+ *
+ * @param isr Callback function that will be called on interrupt.
+ * @param context The context given to the ISR.
+ *
+ * isr(void *context)
+ */
+int gnublin_module_sc16is7x0::intIsrXoff(void (*isr)(void *), void *context) {
+
+    isrXoff = isr;
+    isrXoffContext = context;
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Register an Interrupt Service Routine that will be called on the
+ * RX timeout interrupt, after the data received is delivered. The line has
+ * been silent for 4 character times (see enableRxFraming).
+ *
+ * @param isr Callback function that will be called on interrupt.
+ * @param context The context given to the ISR.
+ *
+ * isr(void *context)
+ */
+int gnublin_module_sc16is7x0::intIsrRxTimeout(void (*isr)(void *), void *context) {
+
+    isrRxTimeout = isr;
+    isrRxTimeoutContext = context;
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Enable the framing mode. The frames are delimited by silences on
+ * the line (Modbus RTU for instance). On RHR interrupts a byte is kept in
+ * the RX FIFO so that the RX timeout interrupt is always raised after the
+ * last byte of a frame, even when the frame length is a multiple of the
+ * trigger level. The end of the frame is signaled by the RX timeout ISR
+ * (see intIsrRxTimeout).
+ *
+ * @param value 1 to enable and 0 to disable.
+ * @return 1.
+ */
+int gnublin_module_sc16is7x0::enableRxFraming(int value) {
+
+    rxFraming = value;
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Enable or disable the RX polling (interrupt mitigation). When the
+ * RHR interrupt is raised (trigger level reached), the RHR interrupt is
+ * disabled and the RX FIFO is polled by pollInt, the RXLVL being read with
+ * the IIR. After idle consecutive polls finding the FIFO empty the RHR
+ * interrupt is enabled again. Under a burst, the data is then received
+ * with a single interrupt instead of one per trigger level.
+ *
+ * The polling is done by the reactor, it calls pollInt every poll interval
+ * while polling (see getPollTimeout). Each poll reads at most the service
+ * budget (see setServiceBudget). The RX timeout interrupt is disabled with
+ * the RHR interrupt, the framing mode could not be used. The interrupts
+ * per second and the bytes per interrupt are given by getIntStats.
+ *
+ * @param value 1 to enable and 0 to disable.
+ * @param idle The number of empty polls before the RHR interrupt is enabled.
+ * @param interval The poll interval in ms.
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_module_sc16is7x0::setRxPolling(int value, unsigned int idle, int interval) {
+
+    errorFlag = false;
+
+    if ((value == 1) && (rxFraming == 1)) {
+        errorFlag = true;
+        errorMessage = "RX polling is not available in framing mode\n";
+        return -1;
+    }
+
+    if ((idle == 0) || (interval < 0)) {
+        errorFlag = true;
+        errorMessage = "Invalid RX polling parameters\n";
+        return -1;
+    }
+
+    rxPollIdle = idle;
+    rxPollInterval = interval;
+    rxPollEnable = value;
+
+    if ((value == 0) && (rxPolling == 1)) {
+        rxPolling = 0;
+        return updateRegister(IER, &config.ierRegister, config.ierRegister | CONF_INT_RHREN, "IER");
+    }
+
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Get the time after which pollInt must be called without edge. The
+ * reactor waits at most this time (see gnublin_irq_reactor::wait).
+ *
+ * @return 0 when the service budget left data in the RX FIFO (see
+ * setServiceBudget), the poll interval in ms while polling the RX FIFO and
+ * -1 otherwise.
+ */
+int gnublin_module_sc16is7x0::getPollTimeout(void) {
+
+    if (serviceMore == 1) {
+        return 0;
+    }
+
+    return (rxPolling == 1) ? rxPollInterval : -1;
+}
+
+
+/**
+ * @~english
+ * @brief Poll the RX FIFO once while in RX polling (see setRxPolling). It
+ * is done by pollInt, it could be called by the callers servicing the IIR
+ * themselves (see sc16is7x0_scheduler).
+ *
+ * @return -1 on error, 1 when data is read and 0 otherwise.
+ */
+int gnublin_module_sc16is7x0::rxPoll(void) {
+
+    errorFlag = false;
+
+    if (rxPolling == 0) {
+        return 0;
+    }
+
+    if (rxAvailableData() < 0) {
+        return -1;
+    }
+
+    return rxPollService();
+}
+
+
+/**
+ * @~english
+ * @brief Register an Interrupt Service Routine that will be called when
+ * the modem lines change (CTS, DSR, RI and CD). The modem interrupt must
+ * be enabled (CONF_INT_MSEN).
+ *
+ * @param isr Callback function that will be called on interrupt. It is given
+ * the value of the MSR, the bits 3:0 tell the lines that changed (see
+ * MSR_DELTA_CTS) and the bits 7:4 their state (see MSR_CTS).
+ * @param context The context given to the ISR.
+ *
+ * isr(unsigned char msr, void *context)
+ */
+int gnublin_module_sc16is7x0::intIsrModem(void (*isr)(unsigned char, void *), void *context) {
+
+    isrModem = isr;
+    isrModemContext = context;
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Register an Interrupt Service Routine that will be called when
+ * data is received, with the times of the chunk. It is used in place of
+ * the data received ISR.
+ *
+ * @param isr Callback function that will be called on interrupt. The buffer
+ * is a view in the RX ring buffer (see intIsrDataReceived). The timestamp
+ * gives the time of the IRQ edge and of the FIFO drain.
+ * @param context The context given to the ISR.
+ *
+ * isr(const char *buffer, int len, const sc16is7x0_timestamp *timestamp, void *context)
+ */
+int gnublin_module_sc16is7x0::intIsrDataTimestamp(void (*isr)(const char *, int, const sc16is7x0_timestamp *, void *), void *context) {
+
+    isrDataTimestamp = isr;
+    isrDataTimestampContext = context;
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Get the times of the last chunk of data received.
+ *
+ * @param timestamp The times of the chunk.
+ */
+void gnublin_module_sc16is7x0::getRxTimestamp(sc16is7x0_timestamp *timestamp) {
+
+    *timestamp = rxTimestamp;
+}
+
+
+/**
+ * @~english
+ * @brief Get the histogram of the latency (in us) from the IRQ edge to the
+ * delivery of the chunks of data received.
+ *
+ * @return The histogram.
+ */
+const sc16is7x0_histogram *gnublin_module_sc16is7x0::getRxLatency(void) {
+
+    return &rxLatency;
+}
+
+
+/**
+ * @~english
+ * @brief Reset the histogram of the RX latency.
+ */
+void gnublin_module_sc16is7x0::resetRxLatency(void) {
+
+    rxLatency.reset();
+}
+
+
+/**
+ * @~english
+ * @brief Get the interrupts counters.
+ *
+ * @return A copy of the counters.
+ */
+sc16is7x0_int_stats gnublin_module_sc16is7x0::getIntStats(void) {
+
+    return intStats;
+}
+
+
+/**
+ * @~english
+ * @brief Reset the interrupts counters and start a new window of the
+ * adaptive trigger levels.
+ */
+void gnublin_module_sc16is7x0::resetIntStats(void) {
+
+    memset(&intStats, 0, sizeof(intStats));
+
+    clock_gettime(CLOCK_MONOTONIC, &adaptiveStart);
+    adaptiveRxInterrupts = 0;
+    adaptiveRxBytes = 0;
+    adaptiveTxInterrupts = 0;
+    adaptiveTxBytes = 0;
+}
+
+
+/**
+ * @~english
+ * @brief Get the receiver line status counters.
+ *
+ * @return A copy of the counters.
+ */
+sc16is7x0_line_stats gnublin_module_sc16is7x0::getLineStats(void) {
+
+    return lineStats;
+}
+
+
+/**
+ * @~english
+ * @brief Reset the receiver line status counters.
+ */
+void gnublin_module_sc16is7x0::resetLineStats(void) {
+
+    memset(&lineStats, 0, sizeof(lineStats));
+}
+
+
+/**
+ * @~english
+ * @brief Set the shadow registers to the chip reset values.
+ */
+void gnublin_module_sc16is7x0::resetConfig(void) {
+
+    config.fifoEnable = 0;
+    config.fcrRegister = 0x00;
+    config.lcrRegister = 0x1d;
+    config.efrRegister = 0x00;
+    config.mcrRegister = 0x00;
+    config.ierRegister = 0x00;
+    config.tlrRegister = 0x00;
+    config.tcrRegister = 0x00;
+    config.efcrRegister = 0x00;
+    config.xonRegister[0] = config.xonRegister[1] = 0x00;
+    config.xoffRegister[0] = config.xoffRegister[1] = 0x00;
+    config.divisor = 0;
+    config.baudRate = 0;
+    config.baudRateError = 0.0;
+
+    /* IER is reset, the RHR interrupt is no more disabled by the polling. */
+    rxPolling = 0;
+}
+
+
+/**
+ * @~english
+ * @brief Write a value to a register.
+ *
+ * @param reg The register to write.
+ * @param value The value to write.
+ * @param name The register name used in the error message.
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_module_sc16is7x0::writeRegister(unsigned char reg, unsigned char value, const char *name) {
+
+    if (transport->send(reg, &value, 1) < 0) {
+        errorFlag = true;
+        errorMessage = std::string("send (") + name + ") Error\n";
+        return -1;
+    }
+
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Write a value to a register only if it differs from its shadow
+ * value. The shadow value is updated on success.
+ *
+ * @param reg The register to write.
+ * @param shadow The shadow value of the register.
+ * @param value The value to write.
+ * @param name The register name used in the error message.
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_module_sc16is7x0::updateRegister(unsigned char reg, unsigned char *shadow, unsigned char value, const char *name) {
+
+    if (*shadow == value) {
+        return 1;
+    }
+
+    if (writeRegister(reg, value, name) < 0) {
+        return -1;
+    }
+
+    *shadow = value;
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Set the special character detection. The received characters are
+ * compared to the special character (XOFF2), on a match the XOFF interrupt
+ * is raised and the RX FIFO is drained up to it. For protocols delimited by
+ * a terminator ('\n', 0x7e, ...), the host then wakes up once per frame
+ * instead of on every RX trigger : enable the XOFF interrupt
+ * (CONF_INT_XOFFEN) without the RHR interrupt for the frames fitting in the
+ * RX FIFO, or with the RHR interrupt and a high trigger level for the
+ * longer ones. The special character is kept in the data. The XOFF2
+ * character is then not available for the software flow control.
+ *
+ * @param character The special character or SPECIAL_CHAR_NONE to disable
+ * the detection, the address detection of the multidrop mode is kept (see
+ * setMultidrop).
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_module_sc16is7x0::setSpecialChar(int character) {
+
+    errorFlag = false;
+    sc16is7x0_xfer xfers[4];
+    unsigned char values[4];
+    int count = 0;
+
+    if (character == SPECIAL_CHAR_NONE) {
+        /* In multidrop mode EFR[5] is the address detection, there is no
+           special character to disable. */
+        if (config.efcrRegister & CONF_MULTIDROP) {
+            return 1;
+        }
+        return updateEFR(config.efrRegister & ~CONF_SPECIAL_CHAR);
+    }
+
+    if ((character < 0) || (character > 0xff)) {
+        errorFlag = true;
+        errorMessage = "Special character is not between 0 and 255\n";
+        return -1;
+    }
+
+    if (config.efrRegister & (CONF_FLOW_TX_XON2 | CONF_FLOW_RX_XON2)) {
+        errorFlag = true;
+        errorMessage = "Special character is not available with XON2/XOFF2 flow control\n";
+        return -1;
+    }
+
+    if (config.efcrRegister & CONF_MULTIDROP) {
+        errorFlag = true;
+        errorMessage = "Special character is not available in multidrop mode\n";
+        return -1;
+    }
+
+    /* XOFF2 and EFR are written in a single transaction. EFR[4] is kept set
+       (enhanced functions). */
+    unsigned char efrValue = config.efrRegister | CONF_SPECIAL_CHAR | (1 << 4);
+    planWrite(xfers, values, &count, LCR, 0xbf);
+    if (character != config.xoffRegister[1]) {
+        planWrite(xfers, values, &count, XOFF2, character);
+    }
+    if (efrValue != config.efrRegister) {
+        planWrite(xfers, values, &count, EFR, efrValue);
+    }
+    planWrite(xfers, values, &count, LCR, config.lcrRegister);
+
+    if (count == 2) {
+        /* Nothing changes. */
+        return 1;
+    }
+
+    if (transport->transfer(xfers, count) < 0) {
+        errorFlag = true;
+        errorMessage = "transfer (special character) Error\n";
+        return -1;
+    }
+
+    config.xoffRegister[1] = character;
+    config.efrRegister = efrValue;
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Get the special character (see setSpecialChar).
+ *
+ * @return The special character or SPECIAL_CHAR_NONE when the detection is
+ * disabled.
+ */
+int gnublin_module_sc16is7x0::getSpecialChar(void) {
+
+    if (!(config.efrRegister & CONF_SPECIAL_CHAR) || (config.efcrRegister & CONF_MULTIDROP)) {
+        return SPECIAL_CHAR_NONE;
+    }
+
+    return config.xoffRegister[1];
+}
+
+
+/**
+ * @~english
+ * @brief Set the multidrop (9-bit) mode with automatic address detection.
+ * The parity bit is the address flag : the data format is set to parity
+ * forced to 0 for the data bytes, the master sends the address bytes with
+ * the parity bit set. The receiver is disabled until an address byte
+ * matching the node address (XOFF2) is received, it is disabled again by
+ * an address byte that does not match. The frames for the other nodes are
+ * discarded by the chip without interrupt and without register access.
+ *
+ * The matching address byte is put in the RX FIFO and raises the receiver
+ * line status interrupt (CONF_INT_RLSEN), it is flagged LSR_PARITY in the
+ * error buffer (see setRxErrorBuffer) and counted in the line statistics
+ * as an address. The special character and the XON2/XOFF2 flow control
+ * are not available in this mode.
+ *
+ * @param address The node address or MULTIDROP_NONE to disable the mode,
+ * the data format is then set back to no parity.
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_module_sc16is7x0::setMultidrop(int address) {
+
+    errorFlag = false;
+    sc16is7x0_xfer xfers[5];
+    unsigned char values[5];
+    int count = 0;
+    unsigned char efrValue;
+    unsigned char lcrValue;
+    unsigned char efcrValue;
+
+    if (address == MULTIDROP_NONE) {
+        efrValue = config.efrRegister & ~CONF_SPECIAL_CHAR;
+        lcrValue = config.lcrRegister & ~CONF_FORCE_PARITY_0;
+        efcrValue = config.efcrRegister & ~(CONF_MULTIDROP | CONF_RX_DISABLE);
+    }
+    else {
+        if ((address < 0) || (address > 0xff)) {
+            errorFlag = true;
+            errorMessage = "Address is not between 0 and 255\n";
+            return -1;
+        }
+
+        if (config.efrRegister & (CONF_FLOW_TX_XON2 | CONF_FLOW_RX_XON2)) {
+            errorFlag = true;
+            errorMessage = "Multidrop mode is not available with XON2/XOFF2 flow control\n";
+            return -1;
+        }
+
+        if (getSpecialChar() != SPECIAL_CHAR_NONE) {
+            errorFlag = true;
+            errorMessage = "Multidrop mode is not available with the special character\n";
+            return -1;
+        }
+
+        /* EFR[4] is kept set (enhanced functions). */
+        efrValue = config.efrRegister | CONF_SPECIAL_CHAR | (1 << 4);
+        lcrValue = config.lcrRegister | CONF_FORCE_PARITY_0;
+        efcrValue = config.efcrRegister | CONF_MULTIDROP | CONF_RX_DISABLE;
+    }
+
+    /* XOFF2, EFR, LCR and EFCR are written in a single transaction, the
+       receiver is disabled last. */
+    if (((address != MULTIDROP_NONE) && (address != config.xoffRegister[1])) || (efrValue != config.efrRegister)) {
+        planWrite(xfers, values, &count, LCR, 0xbf);
+        if ((address != MULTIDROP_NONE) && (address != config.xoffRegister[1])) {
+            planWrite(xfers, values, &count, XOFF2, address);
+        }
+        if (efrValue != config.efrRegister) {
+            planWrite(xfers, values, &count, EFR, efrValue);
+        }
+    }
+    if ((count > 0) || (lcrValue != config.lcrRegister)) {
+        planWrite(xfers, values, &count, LCR, lcrValue);
+    }
+    if (efcrValue != config.efcrRegister) {
+        planWrite(xfers, values, &count, EFCRF, efcrValue);
+    }
+
+    if (count == 0) {
+        /* Nothing changes. */
+        return 1;
+    }
+
+    if (transport->transfer(xfers, count) < 0) {
+        errorFlag = true;
+        errorMessage = "transfer (multidrop) Error\n";
+        return -1;
+    }
+
+    if (address != MULTIDROP_NONE) {
+        config.xoffRegister[1] = address;
+    }
+    config.efrRegister = efrValue;
+    config.lcrRegister = lcrValue;
+    config.efcrRegister = efcrValue;
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Get the node address of the multidrop mode (see setMultidrop).
+ *
+ * @return The address or MULTIDROP_NONE when the mode is disabled.
+ */
+int gnublin_module_sc16is7x0::getMultidrop(void) {
+
+    if (!(config.efcrRegister & CONF_MULTIDROP)) {
+        return MULTIDROP_NONE;
+    }
+
+    return config.xoffRegister[1];
+}
+
+
+/**
+ * @~english
+ * @brief Write the EFR register if its value changes. EFR can only be
+ * accessed when LCR is 0xBF, LCR is restored from its shadow value.
+ *
+ * @param value The value to write.
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_module_sc16is7x0::updateEFR(unsigned char value) {
+
+    if (config.efrRegister == value) {
+        return 1;
+    }
+
+    /* Set LCR to 0xBF to enable access to EFR register. */
+    if (writeRegister(LCR, 0xbf, "LCR") < 0) {
+        return -1;
+    }
+
+    if (writeRegister(EFR, value, "EFR") < 0) {
+        return -1;
+    }
+    config.efrRegister = value;
+
+    /* Restore the LCR register. */
+    if (writeRegister(LCR, config.lcrRegister, "LCR") < 0) {
+        return -1;
+    }
+
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Set EFR[4] to enable the enhanced functions. IER[7:4], FCR[5:4]
+ * and MCR[7:5] can only be modified when EFR[4] is set. EFR[4] is kept set
+ * so that the access to these bits does not require switching LCR anymore.
+ *
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_module_sc16is7x0::enableEnhancedFunctions(void) {
+
+    return updateEFR(config.efrRegister | (1 << 4));
+}
+
+
+/**
+ * @~english
+ * @brief Write the TCR or TLR register if its value changes. TCR and TLR
+ * can only be accessed when MCR[2] and EFR[4] are set. MCR[2] is restored
+ * when it was not already set.
+ *
+ * @param reg The register to write (TCR or TLR).
+ * @param shadow The shadow value of the register.
+ * @param value The value to write.
+ * @param name The register name used in the error message.
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_module_sc16is7x0::updateTcrTlr(unsigned char reg, unsigned char *shadow, unsigned char value, const char *name) {
+
+    if (*shadow == value) {
+        return 1;
+    }
+
+    if (enableEnhancedFunctions() < 0) {
+        return -1;
+    }
+
+    unsigned char mcrValue = config.mcrRegister;
+    if (updateRegister(MCR, &config.mcrRegister, mcrValue | (1 << 2), "MCR") < 0) {
+        return -1;
+    }
+
+    if (updateRegister(reg, shadow, value, name) < 0) {
+        return -1;
+    }
+
+    /* Restore the MCR register. */
+    if (updateRegister(MCR, &config.mcrRegister, mcrValue, "MCR") < 0) {
+        return -1;
+    }
+
+    return 1;
+}
+
+
+
+/**
+ * @~english
+ * @brief Compute the divisor giving the smallest error for the given speed,
+ * with and without the clock prescaler (MCR[7], divide by 4).
+ *
+ * @param baud The speed.
+ * @param divisor The divisor computed.
+ * @param prescaler The prescaler computed (1 or 4).
+ * @param error The error of the actual speed in percent.
+ * @return -1 when the error is above BAUD_MAX_ERROR and 1 on success.
+ */
+int gnublin_module_sc16is7x0::computeDivisor(unsigned int baud, unsigned int *divisor, unsigned int *prescaler, float *error) {
+
+    *divisor = 0;
+    *prescaler = 1;
+    *error = 100.0;
+
+    if (baud == 0) {
+        errorFlag = true;
+        errorMessage = "Invalid baud rate\n";
+        return -1;
+    }
+
+    for (unsigned int p = 1; p <= 4; p *= 4) {
+        unsigned long long clock = (unsigned long long)baud * 16 * p;
+        unsigned long long d = (xtalFrequency + clock / 2) / clock;
+
+        if (d == 0) {
+            d = 1;
+        }
+        if (d > 0xffff) {
+            continue;
+        }
+
+        float actual = (float)xtalFrequency / (16 * p * d);
+        float e = (actual - baud) * 100.0 / baud;
+        if (e < 0) {
+            e = -e;
+        }
+
+        if (e < *error) {
+            *error = e;
+            *divisor = d;
+            *prescaler = p;
+        }
+    }
+
+    if (*error > BAUD_MAX_ERROR) {
+        char message[80];
+        errorFlag = true;
+        snprintf(message, sizeof(message), "Baud rate %u not reachable with a %lu Hz crystal\n", baud, xtalFrequency);
+        errorMessage = message;
+        return -1;
+    }
+
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Drain the RX FIFO into the given buffer. The RHR is read together
+ * with the RXLVL in a single combined transaction. The number of bytes read
+ * from RHR is the level read by the previous transaction. This number of
+ * bytes is always present in the FIFO because only this method drains it.
+ * The last rxKeep bytes are left in the FIFO (see enableRxFraming).
+ *
+ * @param buffer The buffer receiving the data.
+ * @param len The size of the buffer.
+ * @return -1 on error and the number of bytes read on success.
+ */
+int gnublin_module_sc16is7x0::rxBurst(char *buffer, unsigned int len) {
+
+    unsigned char level;
+    unsigned int count = 0;
+    sc16is7x0_xfer xfers[2];
+
+    if (rxLevel == 0) {
+        if (rxAvailableData() < 0) {
+            return -1;
+        }
+    }
+
+    while ((rxLevel > rxKeep) && (count < len)) {
+        unsigned int readLen = len - count;
+        if (readLen > (unsigned int)(rxLevel - rxKeep)) {
+            readLen = rxLevel - rxKeep;
+        }
+
+        xfers[0].reg = RHR;
+        xfers[0].read = 1;
+        xfers[0].buffer = (unsigned char *)(buffer + count);
+        xfers[0].len = readLen;
+        xfers[1].reg = RXLVL;
+        xfers[1].read = 1;
+        xfers[1].buffer = &level;
+        xfers[1].len = 1;
+
+        if (transport->transfer(xfers, 2) < 0) {
+            errorFlag = true;
+            errorMessage = "transfer (RHR/RXLVL) Error\n";
+            rxLevel = 0;
+            return -1;
+        }
+
+        count += readLen;
+        rxLevel = level;
+    }
+
+    return count;
+}
+
+
+
+/**
+ * @~english
+ * @brief Write the given data segments in the TX FIFO. At most the number
+ * of spaces known to be free in the FIFO is written. The THR burst and the
+ * reading of TXLVL are done in a single combined transaction. The level
+ * read sizes the next burst.
+ *
+ * @param iov The data segments to write.
+ * @param iovcnt The number of segments.
+ * @param offset The number of bytes of the first segment already written.
+ * @return -1 on error and the number of bytes written on success.
+ */
+int gnublin_module_sc16is7x0::txBurst(const struct iovec *iov, int iovcnt, unsigned int offset) {
+
+    unsigned char txData[FIFO_SIZE];
+    unsigned char level;
+    unsigned int maxLen;
+    unsigned int count = 0;
+    sc16is7x0_xfer xfers[2];
+
+    if (txSpace == 0) {
+        if (txAvailableSpace() < 0) {
+            return -1;
+        }
+
+        if (txSpace == 0) {
+            return 0;
+        }
+    }
+
+    maxLen = txSpace;
+    if (config.fifoEnable == 0) {
+        maxLen = 1;
+    }
+
+    /* Gather the segments. */
+    for (int i = 0; (i < iovcnt) && (count < maxLen); i++) {
+        unsigned int skip = (i == 0) ? offset : 0;
+        unsigned int len = iov[i].iov_len - skip;
+        if (len > maxLen - count) {
+            len = maxLen - count;
+        }
+
+        memcpy(txData + count, (const char *)iov[i].iov_base + skip, len);
+        count += len;
+    }
+
+    if (count == 0) {
+        return 0;
+    }
+
+    xfers[0].reg = THR;
+    xfers[0].read = 0;
+    xfers[0].buffer = txData;
+    xfers[0].len = count;
+    xfers[1].reg = TXLVL;
+    xfers[1].read = 1;
+    xfers[1].buffer = &level;
+    xfers[1].len = 1;
+
+    if (transport->transfer(xfers, 2) < 0) {
+        errorFlag = true;
+        errorMessage = "transfer (THR/TXLVL) Error\n";
+        txSpace = 0;
+        return -1;
+    }
+
+    txSpace = level;
+    return count;
+}
+
+
+/**
+ * @~english
+ * @brief Write the data waiting in the TX ring buffer in the TX FIFO. The
+ * THR interrupt is enabled while data is waiting in the ring buffer and
+ * disabled once it is empty or while the TX path is parked (CTS inactive).
+ *
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_module_sc16is7x0::txRefill(void) {
+
+    struct iovec iov[2];
+    int iovcnt = 1;
+    int count;
+
+    if (txParked) {
+        /* CTS inactive, resumed by the modem interrupt. */
+        return enableTxInterrupt(0);
+    }
+
+    if (txCount > 0) {
+        iov[0].iov_base = txBuffer + txHead;
+        iov[0].iov_len = TX_BUFFER_SIZE - txHead;
+        if (iov[0].iov_len >= txCount) {
+            iov[0].iov_len = txCount;
+        }
+        else {
+            iov[1].iov_base = txBuffer;
+            iov[1].iov_len = txCount - iov[0].iov_len;
+            iovcnt = 2;
+        }
+
+        if (serviceBudget > 0) {
+            if (iov[0].iov_len >= serviceBudget) {
+                iov[0].iov_len = serviceBudget;
+                iovcnt = 1;
+            }
+            else if ((iovcnt == 2) && (iov[0].iov_len + iov[1].iov_len > serviceBudget)) {
+                iov[1].iov_len = serviceBudget - iov[0].iov_len;
+            }
+        }
+
+        if ((count = txBurst(iov, iovcnt)) < 0) {
+            return -1;
+        }
+
+        txHead = (txHead + count) % TX_BUFFER_SIZE;
+        txCount -= count;
+    }
+
+    return enableTxInterrupt(txCount > 0);
+}
+
+
+/**
+ * @~english
+ * @brief Enable or disable the THR interrupt. Only IER[1] is changed, the
+ * RHR interrupt stays disabled while polling the RX FIFO (see
+ * setRxPolling).
+ *
+ * @param value 1 to enable and 0 to disable.
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_module_sc16is7x0::enableTxInterrupt(int value) {
+
+    unsigned char ier = config.ierRegister & ~CONF_INT_THREN;
+
+    if (value == 1) {
+        ier |= CONF_INT_THREN;
+    }
+
+    return updateRegister(IER, &config.ierRegister, ier, "IER");
+}
+
+
+
+/**
+ * @~english
+ * @brief Update the modem state from the given MSR value. The TX path is
+ * parked while CTS is inactive when the modem interrupts are enabled, the
+ * TX FIFO is refilled from the TX ring buffer when it is resumed.
+ *
+ * @param msr The value of the MSR register.
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_module_sc16is7x0::modemUpdate(unsigned char msr) {
+
+    int parked = txParked;
+
+    modemStatus = msr & ~MSR_DELTAS;
+
+    if (config.ierRegister & (CONF_INT_MSEN | CONF_INT_CTSEN)) {
+        txParked = (msr & MSR_CTS) ? 0 : 1;
+    }
+
+    if (parked && !txParked && (txBufferEnable == 1) && (txCount > 0)) {
+        if (txRefill() < 0) {
+            return -1;
+        }
+    }
+
+    if ((msr & MSR_DELTAS) && (isrModem != NULL)) {
+        isrModem(msr, isrModemContext);
+    }
+
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Wait while the TX path is parked (CTS inactive). The IRQ is waited
+ * for and the interrupts are serviced, the bus is not polled. Without IRQ
+ * source, the MSR is read every TX_PARK_POLL us.
+ *
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_module_sc16is7x0::txParkWait(void) {
+
+    int ret = 0;
+
+    if (irqSource == NULL) {
+        usleep(TX_PARK_POLL);
+        return (readModemStatus() < 0) ? -1 : 1;
+    }
+
+    if (waitInt(-1) < 0) {
+        return -1;
+    }
+
+    for (int i = 0; i < IRQ_MAX_SERVICE; i++) {
+        if ((ret = pollInt()) <= 0) {
+            break;
+        }
+    }
+
+    return (ret < 0) ? -1 : 1;
+}
+
+
+/**
+ * @~english
+ * @brief Read data from the UART until at least the given number of bytes
+ * is read, waiting for the IRQ between the reads.
+ *
+ * @param buffer The data read.
+ * @param len The size of the buffer.
+ * @param min The number of bytes to wait for.
+ * @param timeout The timeout in milliseconds, 0 to return at once and -1 to
+ * wait forever.
+ * @return -1 on error and the number of bytes read on success.
+ */
+int gnublin_module_sc16is7x0::readWait(char *buffer, unsigned int len, unsigned int min, int timeout) {
+
+    errorFlag = false;
+    struct timespec deadline;
+    unsigned int count = 0;
+    int ret = 0;
+
+    if (min > len) {
+        min = len;
+    }
+
+    if (timeout != 0) {
+        if (rxWaitCheck(timeout) < 0) {
+            return -1;
+        }
+
+        if (timeout > 0) {
+            deadlineSet(&deadline, timeout);
+        }
+    }
+
+    while (true) {
+
+        /* Service the pending interrupts. The IRQ line stays active otherwise
+           and no edge is detected. */
+        if (timeout != 0) {
+            for (int i = 0; i < IRQ_MAX_SERVICE; i++) {
+                if ((ret = pollInt()) <= 0) {
+                    break;
+                }
+            }
+            if (ret < 0) {
+                return -1;
+            }
+        }
+
+        if ((ret = read(buffer + count, len - count)) < 0) {
+            return -1;
+        }
+        count += ret;
+
+        if ((count >= min) || (timeout == 0)) {
+            break;
+        }
+
+        if ((ret = rxWaitInt(&deadline, timeout)) < 0) {
+            return -1;
+        }
+        if (ret == 0) {
+            break;
+        }
+    }
+
+    return count;
+}
+
+
+/**
+ * @~english
+ * @brief Check that the data received could be waited for with the IRQ.
+ *
+ * @param timeout The timeout of the wait, 0 when not waiting.
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_module_sc16is7x0::rxWaitCheck(int timeout) {
+
+    if ((isrDataReceived != NULL) || (isrDataTimestamp != NULL)) {
+        errorFlag = true;
+        errorMessage = "Data received ISR is registered\n";
+        return -1;
+    }
+
+    if (timeout == 0) {
+        return 1;
+    }
+
+    if (irqSource == NULL) {
+        errorFlag = true;
+        errorMessage = "No IRQ source set\n";
+        return -1;
+    }
+
+    /* The data is received on the RHR interrupt, by polling or on the
+       special character (XOFF interrupt). */
+    if (((config.ierRegister & CONF_INT_RHREN) == 0) && (rxPolling == 0) &&
+        (((config.ierRegister & CONF_INT_XOFFEN) == 0) || (getSpecialChar() == SPECIAL_CHAR_NONE))) {
+        errorFlag = true;
+        errorMessage = "RHR interrupt is disabled\n";
+        return -1;
+    }
+
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Wait for the IRQ until the given deadline. The wait is limited to
+ * the poll timeout (see getPollTimeout), while polling the RX FIFO or when
+ * the service budget left data in it.
+ *
+ * @param deadline The deadline.
+ * @param timeout The timeout of the deadline, -1 to wait forever.
+ * @return -1 on error, 0 when the deadline is reached and 1 when the RX
+ * FIFO must be checked.
+ */
+int gnublin_module_sc16is7x0::rxWaitInt(const struct timespec *deadline, int timeout) {
+
+    int wait = (timeout > 0) ? deadlineLeft(deadline) : -1;
+    int pollTimeout = getPollTimeout();
+    int ret;
+
+    if ((pollTimeout >= 0) && ((wait < 0) || (wait > pollTimeout))) {
+        if ((ret = waitInt(pollTimeout)) != 0) {
+            return ret;
+        }
+        return 1;
+    }
+
+    return waitInt(wait);
+}
+
+
+/**
+ * @~english
+ * @brief Drain the RX FIFO in the RX ring buffer. The data is read in the
+ * contiguous free space of the ring buffer. When the data received ISR is
+ * registered, it is given a view of each chunk read and the chunk is then
+ * removed from the ring buffer. No memory is allocated. Each chunk is
+ * timestamped when it is drained and its latency from the IRQ edge (see
+ * rxEdgeTime) is recorded.
+ *
+ * @return -1 on error and the number of bytes read on success.
+ */
+int gnublin_module_sc16is7x0::rxFill(void) {
+
+    unsigned int total = 0;
+
+    unsigned int limit = rxSize;
+
+    if ((serviceBudget > 0) && (serviceBudget < limit)) {
+        limit = serviceBudget;
+    }
+
+    while ((rxCount < rxSize) && (total < limit)) {
+
+        /* Restart at the beginning of the ring when it is empty to have the
+           largest contiguous free space. */
+        if (rxCount == 0) {
+            rxHead = 0;
+        }
+
+        unsigned int tail = (rxHead + rxCount) % rxSize;
+        unsigned int part = rxSize - tail;
+        if (part > rxSize - rxCount) {
+            part = rxSize - rxCount;
+        }
+        if (part > limit - total) {
+            part = limit - total;
+        }
+
+        int count = rxBurst(rxData + tail, part);
+        if (count < 0) {
+            return -1;
+        }
+
+        if (count == 0) {
+            break;
+        }
+
+        total += count;
+        if (rxErrors != NULL) {
+            memset(rxErrors + tail, 0, count);
+        }
+        rxDeliver(tail, count);
+
+        /* The FIFO was empty after the last burst. */
+        if (rxLevel <= rxKeep) {
+            break;
+        }
+    }
+
+    /* The budget is exhausted, the interrupt is still pending. */
+    if ((total == limit) && (limit == serviceBudget) && (rxLevel > rxKeep)) {
+        serviceMore = 1;
+    }
+
+    return total;
+}
+
+
+
+/**
+ * @~english
+ * @brief Service the receiver line status interrupt. The LSR is read, its
+ * error bits are the ones of the byte at the top of the RX FIFO. While the
+ * FIFO holds errors, the bytes are read one by one in the RX ring buffer
+ * together with the status of the next byte (one transaction per byte).
+ * The errors are counted and the flags of the bytes are kept in the error
+ * buffer when set.
+ *
+ * @return -1 on error and the number of bytes read on success.
+ */
+int gnublin_module_sc16is7x0::rxLineStatus(void) {
+
+    unsigned char lsr;
+    unsigned int total = 0;
+    sc16is7x0_xfer xfers[2];
+
+    if (transport->receive(LSR, &lsr, 1) < 0) {
+        errorFlag = true;
+        errorMessage = "receive (LSR) Error\n";
+        return -1;
+    }
+
+    lineStats.interrupts++;
+    if (lsr & LSR_OVERRUN) {
+        lineStats.overruns++;
+    }
+
+    /* The level is unknown after the bytes are read one by one. */
+    rxLevel = 0;
+
+    while ((lsr & LSR_DATA) && (lsr & (LSR_FIFO_ERROR | LSR_ERRORS)) && (rxCount < rxSize)) {
+
+        if (rxCount == 0) {
+            rxHead = 0;
+        }
+
+        unsigned int tail = (rxHead + rxCount) % rxSize;
+        unsigned int part = rxSize - tail;
+        unsigned int count = 0;
+        if (part > rxSize - rxCount) {
+            part = rxSize - rxCount;
+        }
+
+        while ((count < part) && (lsr & LSR_DATA) && (lsr & (LSR_FIFO_ERROR | LSR_ERRORS))) {
+            unsigned char errors = lsr & LSR_ERRORS;
+
+            xfers[0].reg = RHR;
+            xfers[0].read = 1;
+            xfers[0].buffer = (unsigned char *)(rxData + tail + count);
+            xfers[0].len = 1;
+            xfers[1].reg = LSR;
+            xfers[1].read = 1;
+            xfers[1].buffer = &lsr;
+            xfers[1].len = 1;
+
+            if (transport->transfer(xfers, 2) < 0) {
+                errorFlag = true;
+                errorMessage = "transfer (RHR/LSR) Error\n";
+                return -1;
+            }
+
+            if (errors & LSR_PARITY) {
+                /* The parity bit flags the address bytes in multidrop
+                   mode. */
+                if (config.efcrRegister & CONF_MULTIDROP) {
+                    lineStats.addresses++;
+                }
+                else {
+                    lineStats.parityErrors++;
+                }
+            }
+            if (errors & LSR_FRAMING) {
+                lineStats.framingErrors++;
+            }
+            if (errors & LSR_BREAK) {
+                lineStats.breaks++;
+            }
+            if (lsr & LSR_OVERRUN) {
+                lineStats.overruns++;
+            }
+            if (rxErrors != NULL) {
+                rxErrors[tail + count] = errors;
+            }
+            count++;
+        }
+
+        total += count;
+        rxDeliver(tail, count);
+    }
+
+    return total;
+}
+
+
+/**
+ * @~english
+ * @brief Deliver a chunk read in the RX ring buffer. The chunk is
+ * timestamped and given to the data received ISR when registered, it is
+ * kept in the ring buffer otherwise.
+ *
+ * @param tail The index of the chunk in the ring buffer.
+ * @param count The number of bytes of the chunk.
+ */
+void gnublin_module_sc16is7x0::rxDeliver(unsigned int tail, unsigned int count) {
+
+    clock_gettime(CLOCK_MONOTONIC, &rxTimestamp.drain);
+    rxLatency.record((rxTimestamp.drain.tv_sec - rxTimestamp.edge.tv_sec) * 1000000 + (rxTimestamp.drain.tv_nsec - rxTimestamp.edge.tv_nsec) / 1000);
+
+    if (isrDataTimestamp != NULL) {
+        isrDataTimestamp(rxData + tail, count, &rxTimestamp, isrDataTimestampContext);
+    }
+    else if (isrDataReceived != NULL) {
+        isrDataReceived(rxData + tail, count, isrDataReceivedContext);
+    }
+    else {
+        rxCount += count;
+    }
+}
+
+
+/**
+ * @~english
+ * @brief Set the edge time of the next chunks received.
+ *
+ * @param edge 1 when the servicing follows an edge of the IRQ source, the
+ * time of the edge is used. The current time is used otherwise.
+ */
+void gnublin_module_sc16is7x0::rxEdgeTime(int edge) {
+
+    if (edge && (irqSource != NULL)) {
+        irqSource->getEdgeTime(&rxTimestamp.edge);
+        if ((rxTimestamp.edge.tv_sec != 0) || (rxTimestamp.edge.tv_nsec != 0)) {
+            return;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &rxTimestamp.edge);
+}
+
+
+/**
+ * @~english
+ * @brief Search the RX ring buffer for the given delimiter. The search
+ * starts after the bytes already searched by the previous calls for the
+ * same delimiter, each
+ * contiguous part of the ring buffer is searched with memchr.
+ *
+ * @param delim The delimiter.
+ * @return The number of bytes up to the delimiter included or 0 when it is
+ * not found.
+ */
+int gnublin_module_sc16is7x0::rxScan(char delim) {
+
+    /* The bytes searched for another delimiter are searched again. */
+    if (delim != rxScanDelim) {
+        rxScanDelim = delim;
+        rxScanned = 0;
+    }
+
+    while (rxScanned < rxCount) {
+        unsigned int start = (rxHead + rxScanned) % rxSize;
+        unsigned int part = rxSize - start;
+        if (part > rxCount - rxScanned) {
+            part = rxCount - rxScanned;
+        }
+
+        const char *found = (const char *)memchr(rxData + start, delim, part);
+        if (found != NULL) {
+            return rxScanned + (found - (rxData + start)) + 1;
+        }
+
+        rxScanned += part;
+    }
+
+    return 0;
+}
+
+
+/**
+ * @~english
+ * @brief Poll the RX FIFO, the RX level being just read. The data is
+ * drained, the RHR interrupt is enabled again after the configured number
+ * of empty polls.
+ *
+ * @return -1 on error, 1 when data is read and 0 otherwise.
+ */
+int gnublin_module_sc16is7x0::rxPollService(void) {
+
+    int ret;
+
+    intStats.rxPolls++;
+
+    if (rxLevel > 0) {
+        rxEdgeTime(0);
+        if ((ret = rxFill()) < 0) {
+            return -1;
+        }
+        intStats.rxBytes += ret;
+        rxPollEmpty = 0;
+        return 1;
+    }
+
+    rxPollEmpty++;
+    if (rxPollEmpty >= rxPollIdle) {
+        /* The data received from now raises the RHR or RX timeout
+           interrupt. */
+        if (updateRegister(IER, &config.ierRegister, config.ierRegister | CONF_INT_RHREN, "IER") < 0) {
+            return -1;
+        }
+        rxPolling = 0;
+    }
+
+    return 0;
+}
+
+
+/**
+ * @~english
+ * @brief Compute the interrupts per second and the bytes per interrupt at
+ * the end of a window of ADAPTIVE_WINDOW ms.
+ *
+ * @return The length of the window in ms when it is over and 0 otherwise.
+ */
+long gnublin_module_sc16is7x0::updateIntRates(void) {
+
+    struct timespec now;
+    long elapsed;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    elapsed = (now.tv_sec - adaptiveStart.tv_sec) * 1000 + (now.tv_nsec - adaptiveStart.tv_nsec) / 1000000L;
+    if (elapsed < ADAPTIVE_WINDOW) {
+        return 0;
+    }
+
+    unsigned long rxInts = intStats.rxInterrupts - adaptiveRxInterrupts;
+    unsigned long rxBytes = intStats.rxBytes - adaptiveRxBytes;
+    unsigned long txInts = intStats.txInterrupts - adaptiveTxInterrupts;
+    unsigned long txBytes = intStats.txBytes - adaptiveTxBytes;
+
+    intStats.rxIntRate = rxInts * 1000.0 / elapsed;
+    intStats.rxBytesPerInt = (rxInts > 0) ? (float)rxBytes / rxInts : 0.0;
+    intStats.txIntRate = txInts * 1000.0 / elapsed;
+    intStats.txBytesPerInt = (txInts > 0) ? (float)txBytes / txInts : 0.0;
+
+    adaptiveStart = now;
+    adaptiveRxInterrupts = intStats.rxInterrupts;
+    adaptiveRxBytes = intStats.rxBytes;
+    adaptiveTxInterrupts = intStats.txInterrupts;
+    adaptiveTxBytes = intStats.txBytes;
+
+    return elapsed;
+}
+
+
+/**
+ * @~english
+ * @brief Retune the RX and TX trigger levels at the end of a window of the
+ * adaptive mode (see setAdaptiveTrigger). Both levels are written in TLR at
+ * once.
+ *
+ * @return -1 on error, 0 when the window is not over and 1 otherwise.
+ */
+int gnublin_module_sc16is7x0::adaptTrigger(void) {
+
+    unsigned long rxBytes = intStats.rxBytes - adaptiveRxBytes;
+    unsigned long txBytes = intStats.txBytes - adaptiveTxBytes;
+    long elapsed;
+
+    if ((elapsed = updateIntRates()) == 0) {
+        return 0;
+    }
+
+    if (config.fifoEnable == 0) {
+        return 1;
+    }
+
+    /* Upper bound of the RX level from the latency : start, data, parity
+       and stop bits of a character. */
+    unsigned int rxMax = FIFO_SIZE - 4;
+    if (config.baudRate > 0) {
+        unsigned int charBits = 1 + (config.lcrRegister & 0x03) + 5 + ((config.lcrRegister & 0x08) ? 1 : 0) + ((config.lcrRegister & 0x04) ? 2 : 1);
+        unsigned long long latencyMax = (unsigned long long)adaptiveLatency * config.baudRate / charBits / 1000000;
+        if (latencyMax < rxMax) {
+            rxMax = latencyMax;
+        }
+    }
+
+    /* The RX FIFO does not fill above the halt level with the automatic
+       RTS or XOFF flow control. */
+    if ((config.efrRegister & (CONF_FLOW_RTS | CONF_FLOW_TX_XON1 | CONF_FLOW_TX_XON2)) && ((config.tcrRegister & 0x0f) != 0) && ((unsigned int)(config.tcrRegister & 0x0f) * 4 < rxMax)) {
+        rxMax = (config.tcrRegister & 0x0f) * 4;
+    }
+
+    unsigned int rxTrigger = rxFifoGetTriggerLevel();
+    unsigned int txTrigger = txFifoGetTriggerLevel();
+    unsigned int rxTarget = (rxBytes * 1000 / elapsed + adaptiveRate - 1) / adaptiveRate;
+    unsigned int txTarget = (txBytes * 1000 / elapsed + adaptiveRate - 1) / adaptiveRate;
+
+    /* Raise at once, lower by one step. */
+    rxTarget = (rxTarget + 3) / 4 * 4;
+    if (rxTarget < rxTrigger) {
+        rxTarget = (rxTrigger > 4) ? rxTrigger - 4 : 4;
+    }
+    if (rxTarget > rxMax) {
+        rxTarget = rxMax / 4 * 4;
+    }
+    if (rxTarget < 4) {
+        rxTarget = 4;
+    }
+
+    txTarget = (txTarget + 3) / 4 * 4;
+    if (txTarget < txTrigger) {
+        txTarget = (txTrigger > 4) ? txTrigger - 4 : 4;
+    }
+    if (txTarget > FIFO_SIZE - ADAPTIVE_TX_HEADROOM) {
+        txTarget = FIFO_SIZE - ADAPTIVE_TX_HEADROOM;
+    }
+    if (txTarget < 4) {
+        txTarget = 4;
+    }
+
+    if ((rxTarget == rxTrigger) && (txTarget == txTrigger)) {
+        return 1;
+    }
+
+    if (updateTcrTlr(TLR, &config.tlrRegister, ((rxTarget / 4) << 4) | (txTarget / 4), "TLR") < 0) {
+        return -1;
+    }
+
+    intStats.adjustments++;
+    return 1;
+}
+
 /* -------------------------------------------------------------------------- */
 
 // 
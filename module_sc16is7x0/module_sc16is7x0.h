@@ -32,11 +32,36 @@
  * RHR Interrupt : Receive data ready (FIFO disable) or RX FIFO above
  *                 trigger level (FIFO enable).
  *                 The data must be read in order to clear the pending
- *                 interrupt. If the data available ISR is registered
- *                 (via intIsrDataAvailable), all data in the RX FIFO
- *                 is read.
+ *                 interrupt. All data in the RX FIFO is read in the RX
+ *                 ring buffer. If the data received ISR is registered
+ *                 (via intIsrDataReceived), it is given a view of the
+ *                 data in the ring buffer. The data is kept in the ring
+ *                 buffer for read otherwise, the reads with a timeout
+ *                 (readTimeout, readExact and readUntil) sleep on the
+ *                 IRQ source until it is received. Each chunk read is
+ *                 timestamped at the IRQ edge and at the FIFO drain (see
+ *                 intIsrDataTimestamp and getRxLatency).
  * THR Interrupt : Transmit FIFO empty (FIFO disable) or TX FIFO passes
  *                 above the trigger level (FIFO enable).
+ *                 When the TX buffer is enabled (via enableTxBuffer), the
+ *                 TX FIFO is refilled from the TX ring buffer.
+ * Modem Int.    : CTS (DSR, RI, CD) change of state (CONF_INT_MSEN) or CTS
+ *                 going inactive (CONF_INT_CTSEN). The MSR is read, the
+ *                 modem ISR (see intIsrModem) is called with it. While CTS
+ *                 is inactive, the TX path is parked : the TX FIFO is not
+ *                 refilled and TXLVL is not polled until CTS is active.
+ * RLSE Int.     : Overrun, parity, framing error or break in the RX FIFO.
+ *                 The LSR is read only on this interrupt. The bytes are
+ *                 read one by one with the status of the next one while
+ *                 the FIFO holds errors, the errors are counted (see
+ *                 getLineStats) and the flags of each byte are kept in the
+ *                 error buffer (see setRxErrorBuffer). In multidrop mode
+ *                 the address byte matching the node address raises it,
+ *                 it is flagged LSR_PARITY and counted as an address.
+ * XOFF Int.     : XOFF or special character received. With the special
+ *                 character detection (see setSpecialChar), the RX FIFO is
+ *                 drained as for the RX timeout, the frame terminator is
+ *                 then in the RX ring buffer.
  * I/O pins      : Input pins change of state.
  *
  */
@@ -68,7 +93,13 @@
 
 /* -------------------------------------------------------------------------- */
 
+#include <poll.h>
+#include <sys/uio.h>
+#include <time.h>
+
 #include "gnublin.h"
+#include "module_irq.h"
+#include "module_sc16is7x0_transport.h"
 
 /* -------------------------------------------------------------------------- */
 
@@ -86,6 +117,8 @@
 #define UART_57600   57600
 #define UART_115200 115200
 #define UART_230400 230400
+#define UART_460800 460800
+#define UART_921600 921600
 
 /* UART data communication format. */
 #define UART_5N1 0x00
@@ -113,12 +146,40 @@
 #define UART_7E2 0x1E
 #define UART_8E2 0x1F
 
-/* Configuration values for the flow control.
-   Software flow control not yet supported. */
+/* Configuration values for the flow control. The software flow control
+   characters are set with setXonXoff. */
 #define CONF_FLOW_NONE     0x00
 #define CONF_FLOW_DISABLED CONF_FLOW_NONE
 #define CONF_FLOW_CTS      0x80
 #define CONF_FLOW_RTS      0x40
+#define CONF_FLOW_TX_XON1  0x08  /* Send XOFF1/XON1 when the RX FIFO reaches the halt/resume levels */
+#define CONF_FLOW_TX_XON2  0x04  /* Send XOFF2/XON2 when the RX FIFO reaches the halt/resume levels */
+#define CONF_FLOW_RX_XON1  0x02  /* Stop/resume the transmission when XOFF1/XON1 is received */
+#define CONF_FLOW_RX_XON2  0x01  /* Stop/resume the transmission when XOFF2/XON2 is received */
+#define CONF_FLOW_XONXOFF  (CONF_FLOW_TX_XON1 | CONF_FLOW_RX_XON1)
+#define CONF_FLOW_MASK     0xcf
+
+/* Configuration values for the RS-485 mode (EFCR[5:4]). */
+#define CONF_RS485_NONE    0x00
+#define CONF_RS485_AUTO    0x10  /* The RTS pin drives the transceiver direction, LOW during the transmission */
+#define CONF_RS485_INVERT  0x20  /* With CONF_RS485_AUTO, the RTS pin is HIGH during the transmission */
+#define CONF_RS485_MASK    0x30
+
+/* Multidrop mode (EFCR[1:0]). The parity bit flags the address bytes, the
+   address of the node is XOFF2. */
+#define CONF_MULTIDROP   0x01  /* 9-bit mode */
+#define CONF_RX_DISABLE  0x02  /* Receiver disabled until the address matches */
+#define CONF_FORCE_PARITY_0 0x38  /* LCR[5:3], the parity bit of the data bytes is 0 */
+#define MULTIDROP_NONE -1
+
+/* Special character detection (EFR[5]). The special character is XOFF2, it
+   is put in the RX FIFO and raises the XOFF interrupt. */
+#define CONF_SPECIAL_CHAR 0x20
+#define SPECIAL_CHAR_NONE -1
+
+/* Default software flow control characters. */
+#define XON_DEFAULT  0x11  /* DC1 */
+#define XOFF_DEFAULT 0x13  /* DC3 */
 
 /* Interrupts configuration for the UART. */
 #define CONF_INT_NONE     0x00  /* Disable all UART interrupts */
@@ -142,42 +203,89 @@
 #define INT_XOFF   0x10  /* Receive XOff signal or special character */
 #define INT_CTSRTS 0x20  /* CTS, RTS change of state from active (LOW) to inactive (HIGH) */
 
+/* Line status (LSR). The error bits 4:2 are the ones of the byte at the
+   top of the RX FIFO. */
+#define LSR_DATA       0x01  /* At least one byte in the RX FIFO */
+#define LSR_OVERRUN    0x02  /* Overrun error, the received data was lost */
+#define LSR_PARITY     0x04  /* Parity error */
+#define LSR_FRAMING    0x08  /* Framing error */
+#define LSR_BREAK      0x10  /* Break interrupt */
+#define LSR_THR_EMPTY  0x20  /* THR empty */
+#define LSR_TX_EMPTY   0x40  /* THR and TSR empty */
+#define LSR_FIFO_ERROR 0x80  /* At least one error in the RX FIFO */
+#define LSR_ERRORS     (LSR_PARITY | LSR_FRAMING | LSR_BREAK)
+
+/* Modem status (MSR). The delta bits are cleared by reading MSR. */
+#define MSR_DELTA_CTS  0x01  /* CTS changed */
+#define MSR_DELTA_DSR  0x02  /* DSR changed (SC16IS750/760) */
+#define MSR_TRAIL_RI   0x04  /* RI changed from active to inactive (SC16IS750/760) */
+#define MSR_DELTA_CD   0x08  /* CD changed (SC16IS750/760) */
+#define MSR_CTS        0x10  /* CTS active (pin LOW) */
+#define MSR_DSR        0x20  /* DSR active (SC16IS750/760) */
+#define MSR_RI         0x40  /* RI active (SC16IS750/760) */
+#define MSR_CD         0x80  /* CD active (SC16IS750/760) */
+#define MSR_DELTAS     (MSR_DELTA_CTS | MSR_DELTA_DSR | MSR_TRAIL_RI | MSR_DELTA_CD)
+
+#define TX_PARK_POLL   1000  /* Period in us at which the CTS is polled without IRQ source. */
+
 /* Configuration values for the I/Os. */
 #define CONF_IO_DEFAULT 0x00
 #define CONF_IO_LATCH   0x01
 
 /* Registers definition. */
-#define RHR     (0x00 << 3)  /* Receive Holding Register (read) */
-#define THR     (0x00 << 3)  /* Transmit Holding Register (write) */
-#define IER     (0x01 << 3)  /* Interupt Enable Register (read/write) */
-#define IIR     (0x02 << 3)  /* Interrupt Identification Register (read) */
-#define FCR     (0x02 << 3)  /* FIFO Control Register (write) */
-#define LCR     (0x03 << 3)  /* Line Control Register (read/write) */
-#define MCR     (0x04 << 3)  /* Modem Control Register (read/write) */
-#define LSR     (0x05 << 3)  /* Line Status Register (read) */
-#define MSR     (0x06 << 3)  /* Modem Status Register (read) */
-#define SPR     (0x07 << 3)  /* Scratchpad Register (read/write) */
-#define TCR     (0x06 << 3)  /* Transmission Control Register (read/write) - Accessible only when MCR[2] is 1 and EFR[4] is 1 */
-#define TLR     (0x07 << 3)  /* Trigger Level Register (read/write) - Accessible only when MCR[2] is 1 and EFR[4] is 1 */
-#define TXLVL   (0x08 << 3)  /* Transmit FIFO Level Register (read) */
-#define RXLVL   (0x09 << 3)  /* Receive FIFO Level Register (read) */
-#define IODIR   (0x0A << 3)  /* IO Pin Direction Register (read/write) */
-#define IOSTATE (0x0B << 3)  /* IO States Register (read) */
-#define IOINTEN (0x0C << 3)  /* IO Interrupt Enable Register (read/write) */
-#define IOCTRL  (0x0E << 3)  /* IO Control Register (read/write) */
-#define EFCRF   (0x0F << 3)  /* Extra Features Register (read/write) */
-#define DLL     (0x00 << 3)  /* Divisor Latch LSB (read/write) - Accessile only when LCR[7] is logic 1 */
-#define DLH     (0x01 << 3)  /* Divisor Latch MSB (read/write) - Accessile only when LCR[7] is logic 1 */
-#define EFR     (0x02 << 3)  /* Enhanced Features Register (read/write) - Accessible only when LCR is set to 10111111 (0xBF) */
-#define XON1    (0x04 << 3)  /* Xon1 Word (read/write) - Accessible only when LCR is set to 10111111 (0xBF) */
-#define XON2    (0x05 << 3)  /* Xon2 Word (read/write) - Accessible only when LCR is set to 10111111 (0xBF) */
-#define XOFF1   (0x06 << 3)  /* Xoff1 Word (read/write) - Accessible only when LCR is set to 10111111 (0xBF) */
-#define XOFF2   (0x07 << 3)  /* Xoff2 Word (read/write) - Accessible only when LCR is set to 10111111 (0xBF) */
-
-/* Registers access are shifted 3 bit left because they are encoded in the bits 3:0 of
-   the subaddress. (See section 10.4 of the SC16IS750 datasheet) */
-
-#define XTAL_FREQ 14745600
+#define RHR     0x00  /* Receive Holding Register (read) */
+#define THR     0x00  /* Transmit Holding Register (write) */
+#define IER     0x01  /* Interupt Enable Register (read/write) */
+#define IIR     0x02  /* Interrupt Identification Register (read) */
+#define FCR     0x02  /* FIFO Control Register (write) */
+#define LCR     0x03  /* Line Control Register (read/write) */
+#define MCR     0x04  /* Modem Control Register (read/write) */
+#define LSR     0x05  /* Line Status Register (read) */
+#define MSR     0x06  /* Modem Status Register (read) */
+#define SPR     0x07  /* Scratchpad Register (read/write) */
+#define TCR     0x06  /* Transmission Control Register (read/write) - Accessible only when MCR[2] is 1 and EFR[4] is 1 */
+#define TLR     0x07  /* Trigger Level Register (read/write) - Accessible only when MCR[2] is 1 and EFR[4] is 1 */
+#define TXLVL   0x08  /* Transmit FIFO Level Register (read) */
+#define RXLVL   0x09  /* Receive FIFO Level Register (read) */
+#define IODIR   0x0A  /* IO Pin Direction Register (read/write) */
+#define IOSTATE 0x0B  /* IO States Register (read) */
+#define IOINTEN 0x0C  /* IO Interrupt Enable Register (read/write) */
+#define IOCTRL  0x0E  /* IO Control Register (read/write) */
+#define EFCRF   0x0F  /* Extra Features Register (read/write) */
+#define DLL     0x00  /* Divisor Latch LSB (read/write) - Accessile only when LCR[7] is logic 1 */
+#define DLH     0x01  /* Divisor Latch MSB (read/write) - Accessile only when LCR[7] is logic 1 */
+#define EFR     0x02  /* Enhanced Features Register (read/write) - Accessible only when LCR is set to 10111111 (0xBF) */
+#define XON1    0x04  /* Xon1 Word (read/write) - Accessible only when LCR is set to 10111111 (0xBF) */
+#define XON2    0x05  /* Xon2 Word (read/write) - Accessible only when LCR is set to 10111111 (0xBF) */
+#define XOFF1   0x06  /* Xoff1 Word (read/write) - Accessible only when LCR is set to 10111111 (0xBF) */
+#define XOFF2   0x07  /* Xoff2 Word (read/write) - Accessible only when LCR is set to 10111111 (0xBF) */
+
+/* Registers index. The index is encoded in the subaddress (I2C) or in the
+   register address byte (SPI) by the transport. (See
+   module_sc16is7x0_transport.h) */
+
+#define XTAL_FREQ 14745600  /* Default crystal frequency (see setCrystalFrequency). */
+
+#define BAUD_MAX_ERROR 3.0  /* Maximum baud rate error in percent. */
+
+#define FIFO_SIZE 64  /* Size of the RX and TX FIFO. */
+
+#define TX_BUFFER_SIZE 1024  /* Size of the TX ring buffer (see enableTxBuffer). */
+#define RX_BUFFER_SIZE 1024  /* Size of the RX ring buffer. */
+
+/* Adaptive trigger levels (see setAdaptiveTrigger). */
+#define ADAPTIVE_WINDOW          100   /* Evaluation window in ms. */
+#define ADAPTIVE_DEFAULT_RATE    1000  /* Default maximum number of interrupts per second. */
+#define ADAPTIVE_DEFAULT_LATENCY 2000  /* Default maximum RX latency in us. */
+#define ADAPTIVE_TX_HEADROOM     8     /* Bytes left in the TX FIFO when the THR interrupt occurs. */
+
+/* RX polling after the interrupts of a burst (see setRxPolling). */
+#define RX_POLL_IDLE     4  /* Default number of empty polls before the RHR interrupt is enabled again. */
+#define RX_POLL_INTERVAL 1  /* Default poll interval in ms. */
+
+/* Latency histogram (see sc16is7x0_histogram). */
+#define HISTOGRAM_SUB_BUCKETS 8                              /* Linear buckets per power of two. */
+#define HISTOGRAM_BUCKETS     (HISTOGRAM_SUB_BUCKETS * 30)  /* Values up to 2^32 - 1. */
 
 /* -------------------------------------------------------------------------- */
 
@@ -186,12 +294,143 @@
  * @~english
  * @brief Class to save configuration parameters. Save write only registers
  * values too.
+ *
+ * The registers values are a shadow of the chip configuration registers.
+ * They are used to avoid reading a register before modifying it and to skip
+ * writing a register when its value does not change.
  */
 class sc16is7x0_config {
     
  public :
     int fifoEnable;
     unsigned char fcrRegister;
+    unsigned char lcrRegister;
+    unsigned char efrRegister;
+    unsigned char mcrRegister;
+    unsigned char ierRegister;
+    unsigned char tlrRegister;
+    unsigned char tcrRegister;
+    unsigned char efcrRegister;
+    unsigned char xonRegister[2];   /* XON1 and XON2. */
+    unsigned char xoffRegister[2];  /* XOFF1 and XOFF2. */
+    unsigned int divisor;  /* DLL/DLH, 0 when unknown. */
+    unsigned int baudRate;  /* Actual baud rate, 0 when unknown. */
+    float baudRateError;    /* Error of the actual baud rate in percent. */
+};
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @class sc16is7x0_uart_config
+ * @~english
+ * @brief UART configuration applied at once with configure. The default
+ * values are the ones set by initUART.
+ */
+class sc16is7x0_uart_config {
+
+ public :
+    unsigned int baudRate;        /* UART_300 to UART_921600. */
+    unsigned char format;         /* UART_8N1, ... */
+    unsigned char flow;           /* CONF_FLOW_xxx mask. */
+    unsigned int flowResume;      /* RX FIFO level to resume the transmission (0 to 60, multiple of 4). */
+    unsigned int flowHalt;        /* RX FIFO level to halt the transmission (0 to 60, multiple of 4). */
+    unsigned char xon[2];         /* XON1 and XON2 characters. */
+    unsigned char xoff[2];        /* XOFF1 and XOFF2 characters. */
+    int fifoEnable;
+    unsigned int rxTriggerLevel;  /* RX FIFO interrupt trigger level. */
+    unsigned int txTriggerLevel;  /* TX FIFO interrupt trigger level. */
+    unsigned char interrupt;      /* CONF_INT_xxx mask. */
+
+    sc16is7x0_uart_config(void);
+};
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @class sc16is7x0_int_stats
+ * @~english
+ * @brief Interrupts counters. The rates are computed by pollInt over
+ * windows of ADAPTIVE_WINDOW ms, the last complete window is given.
+ */
+class sc16is7x0_int_stats {
+
+ public :
+    unsigned long rxInterrupts;  /* RX interrupts serviced (RHR, RX timeout and line status). */
+    unsigned long rxBytes;       /* Bytes read on RX interrupts and polls. */
+    unsigned long rxPolls;       /* RXLVL polls done in the RX polling mode. */
+    unsigned long txInterrupts;  /* THR interrupts serviced. */
+    unsigned long txBytes;       /* Bytes written on THR interrupts. */
+    unsigned long adjustments;   /* Trigger level changes done by the adaptive mode. */
+    float rxIntRate;             /* RX interrupts per second. */
+    float rxBytesPerInt;         /* Bytes per RX interrupt. */
+    float txIntRate;             /* THR interrupts per second. */
+    float txBytesPerInt;         /* Bytes per THR interrupt. */
+};
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @class sc16is7x0_line_stats
+ * @~english
+ * @brief Receiver line status counters. They are updated on the receiver
+ * line status interrupts (see CONF_INT_RLSEN).
+ */
+class sc16is7x0_line_stats {
+
+ public :
+    unsigned long interrupts;     /* Receiver line status interrupts serviced. */
+    unsigned long overruns;       /* Overrun errors, the host is too slow. */
+    unsigned long parityErrors;   /* Bytes received with a parity error. */
+    unsigned long framingErrors;  /* Bytes received with a framing error. */
+    unsigned long breaks;         /* Break conditions received. */
+    unsigned long addresses;      /* Address bytes received in multidrop mode. */
+};
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @class sc16is7x0_timestamp
+ * @~english
+ * @brief Times of a chunk of received data (CLOCK_MONOTONIC).
+ */
+class sc16is7x0_timestamp {
+
+ public :
+    struct timespec edge;   /* Edge of the IRQ line detected (servicing start without IRQ source). */
+    struct timespec drain;  /* Chunk read from the RX FIFO. */
+};
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @class sc16is7x0_histogram
+ * @~english
+ * @brief Histogram of values with a constant relative precision (HDR
+ * style). The values below 2 * HISTOGRAM_SUB_BUCKETS are counted exactly,
+ * each power of two above is split in HISTOGRAM_SUB_BUCKETS linear buckets
+ * (12.5% precision). Recording is O(1) and does not allocate memory.
+ */
+class sc16is7x0_histogram {
+
+ protected :
+    unsigned long buckets[HISTOGRAM_BUCKETS];
+    unsigned long count;
+    unsigned long min;
+    unsigned long max;
+    unsigned long long sum;
+
+    static int bucketIndex(unsigned long value);
+    static unsigned long bucketValue(int index);
+
+ public :
+    sc16is7x0_histogram(void);
+    void reset(void);
+    void record(unsigned long value);
+    unsigned long getCount(void) const;
+    unsigned long getMin(void) const;
+    unsigned long getMax(void) const;
+    double getMean(void) const;
+    unsigned long getPercentile(double percent) const;
 };
 
 /* -------------------------------------------------------------------------- */
@@ -199,20 +438,104 @@ class sc16is7x0_config {
 /**
  * @class gnublin_module_sc16is7x0
  * @~english
- * @brief Class for accessing the SC16IS7x0 single uart via I2C.
+ * @brief Class for accessing the SC16IS7x0 single uart via I2C or SPI.
  */
-class gnublin_module_sc16is7x0 {
+class gnublin_module_sc16is7x0 : public gnublin_irq_handler {
 
  protected :
-    gnublin_i2c i2c;
+    sc16is7x0_transport_i2c i2c;
+    sc16is7x0_transport *transport;  /* The I2C transport or the transport set with setTransport. */
     bool errorFlag;
     std::string errorMessage;
 
     int fifoEnable;
+    unsigned long xtalFrequency;
     sc16is7x0_config config;
-    
-    void (*isrDataReceived)(char *, int);
+    int rxLevel;  /* Number of bytes known to be in the RX FIFO. */
+    int txSpace;  /* Number of spaces known to be free in the TX FIFO. */
+
+    int txBufferEnable;
+    char txBuffer[TX_BUFFER_SIZE];
+    unsigned int txHead;   /* Index of the next byte to send. */
+    unsigned int txCount;  /* Number of bytes waiting in the ring. */
+
+    char rxBuffer[RX_BUFFER_SIZE];
+    char *rxData;          /* The RX ring, rxBuffer or a buffer given by the caller. */
+    unsigned int rxSize;
+    unsigned int rxHead;   /* Index of the next byte to read. */
+    unsigned int rxCount;  /* Number of bytes waiting in the ring. */
+    unsigned int rxScanned;  /* Number of bytes searched by readUntil. */
+    char rxScanDelim;        /* Delimiter searched by readUntil. */
+    unsigned char *rxErrors;    /* Error flags (LSR[4:2]) of the bytes of the ring, NULL when disabled. */
+    unsigned int rxErrorsSize;
+
+    void (*isrDataReceived)(const char *, int, void *);
+    void *isrDataReceivedContext;
+    void (*isrDataTimestamp)(const char *, int, const sc16is7x0_timestamp *, void *);
+    void *isrDataTimestampContext;
     void (*isrSpaceAvailable)(int);
+    void (*isrXoff)(void *);
+    void *isrXoffContext;
+    void (*isrModem)(unsigned char, void *);
+    void *isrModemContext;
+    void (*isrRxTimeout)(void *);
+    void *isrRxTimeoutContext;
+
+    int rxFraming;  /* The RX timeout interrupt delimits the frames. */
+    int rxKeep;     /* Number of bytes left in the RX FIFO by rxBurst. */
+
+    unsigned char modemStatus;  /* Last MSR read, the delta bits cleared. */
+    int txParked;               /* CTS inactive, the TX path waits for the modem interrupt. */
+
+    unsigned int serviceBudget;  /* Maximum number of bytes moved per interrupt, 0 for no limit. */
+    int serviceMore;             /* The budget left data in the RX FIFO, pollInt must be called again. */
+
+    sc16is7x0_timestamp rxTimestamp;  /* Times of the last chunk received. */
+    sc16is7x0_histogram rxLatency;    /* Latency from the IRQ edge to the chunk delivery in us. */
+
+    sc16is7x0_line_stats lineStats;
+
+    sc16is7x0_int_stats intStats;
+    int adaptiveEnable;
+    unsigned int adaptiveRate;     /* Maximum number of interrupts per second. */
+    unsigned int adaptiveLatency;  /* Maximum RX latency in us. */
+    struct timespec adaptiveStart; /* Start of the current window. */
+    unsigned long adaptiveRxInterrupts;  /* Counters at the start of the window. */
+    unsigned long adaptiveRxBytes;
+    unsigned long adaptiveTxInterrupts;
+    unsigned long adaptiveTxBytes;
+
+    int rxPollEnable;
+    int rxPolling;                /* The RHR interrupt is disabled, RXLVL is polled. */
+    unsigned int rxPollIdle;      /* Number of empty polls before the RHR interrupt is enabled. */
+    unsigned int rxPollEmpty;     /* Number of consecutive empty polls. */
+    int rxPollInterval;           /* Poll interval in ms. */
+
+    void resetConfig(void);
+    int writeRegister(unsigned char reg, unsigned char value, const char *name);
+    int updateRegister(unsigned char reg, unsigned char *shadow, unsigned char value, const char *name);
+    int updateEFR(unsigned char value);
+    int updateTcrTlr(unsigned char reg, unsigned char *shadow, unsigned char value, const char *name);
+    int enableEnhancedFunctions(void);
+    int computeDivisor(unsigned int baud, unsigned int *divisor, unsigned int *prescaler, float *error);
+    int rxBurst(char *buffer, unsigned int len);
+    int txBurst(const struct iovec *iov, int iovcnt, unsigned int offset = 0);
+    int txRefill(void);
+    int enableTxInterrupt(int value);
+    int txParkWait(void);
+    int modemUpdate(unsigned char msr);
+    int rxFill(void);
+    int rxLineStatus(void);
+    void rxDeliver(unsigned int tail, unsigned int count);
+    int rxScan(char delim);
+    int readWait(char *buffer, unsigned int len, unsigned int min, int timeout);
+    int rxWaitCheck(int timeout);
+    int rxWaitInt(const struct timespec *deadline, int timeout);
+    void rxEdgeTime(int edge);
+    int rxPollService(void);
+    long updateIntRates(void);
+    int adaptTrigger(void);
+    virtual int serviceInt(int interrupt);
 
  public :
     gnublin_module_sc16is7x0(int address = 0x20, std::string filename = "/dev/i2c-1");
@@ -222,37 +545,85 @@ class gnublin_module_sc16is7x0 {
     bool fail(void);
     void setAddress(int address);
     void setDevicefile(std::string filename);
+    int setTransport(sc16is7x0_transport *transport);
+    sc16is7x0_transport *getTransport(void);
     int softReset(void);
+    int syncConfig(void);
 
     /* UART */
     int initUART(void);
+    int configure(sc16is7x0_uart_config *uartConfig);
+    int setCrystalFrequency(unsigned long frequency);
     int setBaudRate(unsigned int baud);
+    unsigned int getBaudRate(void);
+    float getBaudRateError(void);
     int setDataFormat(unsigned char format);
     int setModemControl(void);
     int setFlowControl(unsigned char flow);
     int setFlowTriggers(unsigned int resume, unsigned int halt);
+    int setRs485(unsigned char mode);
+    int setXonXoff(unsigned char xon1 = XON_DEFAULT, unsigned char xoff1 = XOFF_DEFAULT, unsigned char xon2 = XON_DEFAULT, unsigned char xoff2 = XOFF_DEFAULT);
+    int setSpecialChar(int character);
+    int getSpecialChar(void);
+    int setMultidrop(int address);
+    int getMultidrop(void);
     int setInterrupt(unsigned char interrupt);
     int enableFifo(int value);
     int rxFifoSetTriggerLevel(unsigned int len);
     int txFifoSetTriggerLevel(unsigned int len);
+    unsigned int rxFifoGetTriggerLevel(void);
+    unsigned int txFifoGetTriggerLevel(void);
+    int setAdaptiveTrigger(int value, unsigned int maxIntRate = ADAPTIVE_DEFAULT_RATE, unsigned int maxLatency = ADAPTIVE_DEFAULT_LATENCY);
     int rxEmptyFifo(void);
     int resetRxFifo(void);
     int resetTxFifo(void);
     int rxAvailableData(void);
     int txAvailableSpace(void);
     unsigned char readLineStatus(void);
+    int readModemStatus(void);
+    int isCtsActive(void);
     int enableLoopback(void);
     int writeByte(const char byte);
     int write(const char *buffer, unsigned int len);
+    int writev(const struct iovec *iov, int iovcnt);
+    int enableTxBuffer(int value);
+    int txBufferedData(void);
+    int flush(int timeout = -1);
+    int waitTxComplete(int timeout = -1);
     int readByte(char *byte);
-    int read(char *buffer, unsigned int len);
+    int read(char *buffer, unsigned int len, unsigned char *errors = NULL);
+    int readTimeout(char *buffer, unsigned int len, int timeout);
+    int readExact(char *buffer, unsigned int len, int timeout = -1);
+    int setRxBuffer(char *buffer, unsigned int size);
+    int setRxErrorBuffer(unsigned char *buffer, unsigned int size);
+    const unsigned char *getRxErrors(const char *data);
+    sc16is7x0_line_stats getLineStats(void);
+    void resetLineStats(void);
+    int readUntil(char delim, const char **data, int timeout = 0);
+    int readLine(const char **line, int timeout = 0);
 
     /* Interrupts */
     int isIntPending(void);
     int whichInt(void);
+    int waitInt(int timeout);
     virtual int pollInt(void);
-    int intIsrDataReceived(void (*isr)(char *, int));
+    int serviceIIR(unsigned char iir);
+    int setServiceBudget(unsigned int bytes);
+    int intIsrDataReceived(void (*isr)(const char *, int, void *), void *context = NULL);
+    int intIsrDataTimestamp(void (*isr)(const char *, int, const sc16is7x0_timestamp *, void *), void *context = NULL);
+    void getRxTimestamp(sc16is7x0_timestamp *timestamp);
+    const sc16is7x0_histogram *getRxLatency(void);
+    void resetRxLatency(void);
     int intIsrSpaceAvailable(void (*isr)(int));
+    int intIsrXoff(void (*isr)(void *), void *context = NULL);
+    int intIsrModem(void (*isr)(unsigned char, void *), void *context = NULL);
+    int intIsrRxTimeout(void (*isr)(void *), void *context = NULL);
+    int enableRxFraming(int value);
+    int setRxPolling(int value, unsigned int idle = RX_POLL_IDLE, int interval = RX_POLL_INTERVAL);
+    int getPollTimeout(void);
+    int rxPoll(void);
+    sc16is7x0_int_stats getIntStats(void);
+    void resetIntStats(void);
 };
 
 /* -------------------------------------------------------------------------- */
@@ -0,0 +1,328 @@
+// module_sc16is7x0_scheduler.cpp --- 
+// 
+// Filename     : module_sc16is7x0_scheduler.cpp
+// Description  : Class for servicing many SC16IS7x0 chips sharing IRQ lines and buses.
+// Author       : Christophe Burki
+// Maintainer   : Christophe Burki
+// Created      : Sat Oct 17 16:24:18 2026
+// Version      : 1.0.0
+// Last-Updated : 
+//           By : 
+//     Update # : 0
+// URL          : 
+// Keywords     : 
+// Compatibility: 
+// 
+// 
+
+// Commentary   : 
+// 
+// 
+// 
+// 
+
+// Change log:
+// 
+// 
+// 
+// 
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 3 as
+// published by the Free Software Foundation.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program; see the file LICENSE.  If not, write to the
+// Free Software Foundation, Inc., 51 Franklin Street, Fifth
+// ;; Floor, Boston, MA 02110-1301, USA.
+// 
+// 
+
+// Code         :
+
+/* -------------------------------------------------------------------------- */
+
+#include "module_sc16is7x0_scheduler.h"
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @~english
+ * @brief Create a scheduler without chip.
+ *
+ * @param budget The number of bytes moved per chip and per pass.
+ */
+sc16is7x0_scheduler::sc16is7x0_scheduler(unsigned int budget) {
+
+    errorFlag = false;
+    count = 0;
+    next = 0;
+    passes = 0;
+    services = 0;
+    this->budget = budget;
+}
+
+
+/**
+ * @~english
+ * @brief Get the last error message.
+ *
+ * @return The error message as c-string.
+ */
+const char* sc16is7x0_scheduler::getErrorMessage(void) {
+
+    return errorMessage.c_str();
+}
+
+
+/**
+ * @~english
+ * @brief Return whether the action fail or not.
+ *
+ * @return A boolean value indicating if the action fail or not.
+ */
+bool sc16is7x0_scheduler::fail(void) {
+
+    return errorFlag;
+}
+
+
+/**
+ * @~english
+ * @brief Add a chip to service. Its service budget is set to the budget
+ * of the scheduler.
+ *
+ * @param uart The chip.
+ * @return -1 on error and 1 on success.
+ */
+int sc16is7x0_scheduler::add(gnublin_module_sc16is7x0 *uart) {
+
+    errorFlag = false;
+
+    if (count == SCHEDULER_MAX_UARTS) {
+        errorFlag = true;
+        errorMessage = "Too many UARTs\n";
+        return -1;
+    }
+
+    uarts[count++] = uart;
+    return uart->setServiceBudget(budget);
+}
+
+
+/**
+ * @~english
+ * @brief Remove a chip. Its service budget is removed.
+ *
+ * @param uart The chip.
+ * @return -1 on error and 1 on success.
+ */
+int sc16is7x0_scheduler::remove(gnublin_module_sc16is7x0 *uart) {
+
+    errorFlag = false;
+
+    for (int i = 0; i < count; i++) {
+        if (uarts[i] == uart) {
+            for (int j = i + 1; j < count; j++) {
+                uarts[j - 1] = uarts[j];
+            }
+            count--;
+            next = 0;
+            return uart->setServiceBudget(0);
+        }
+    }
+
+    errorFlag = true;
+    errorMessage = "UART not registered\n";
+    return -1;
+}
+
+
+/**
+ * @~english
+ * @brief Set the number of bytes moved per chip and per pass.
+ *
+ * @param bytes The budget, 0 for no limit.
+ * @return 1.
+ */
+int sc16is7x0_scheduler::setBudget(unsigned int bytes) {
+
+    budget = bytes;
+    for (int i = 0; i < count; i++) {
+        uarts[i]->setServiceBudget(budget);
+    }
+
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Do a pass : scan the IIR of all the chips and service the chips
+ * with a pending interrupt.
+ *
+ * @return -1 on error and the number of chips serviced on success.
+ */
+int sc16is7x0_scheduler::pollInt(void) {
+
+    errorFlag = false;
+    unsigned char iir[SCHEDULER_MAX_UARTS];
+    int serviced = 0;
+
+    if (count == 0) {
+        return 0;
+    }
+
+    if (scan(iir) < 0) {
+        return -1;
+    }
+    passes++;
+
+    for (int k = 0; k < count; k++) {
+        int i = (next + k) % count;
+
+        if (uarts[i]->getPollTimeout() >= 0) {
+            int ret = uarts[i]->rxPoll();
+            if (ret < 0) {
+                errorFlag = true;
+                errorMessage = uarts[i]->getErrorMessage();
+                return -1;
+            }
+            serviced += ret;
+        }
+
+        if ((iir[i] & 0x01) == 1) {
+            /* No pending interrupt, the work left by the budget is done. */
+            uarts[i]->serviceIIR(iir[i]);
+            continue;
+        }
+
+        /* The chips share the IRQ source of the scheduler, its edge time
+           is the one of the data received. */
+        if (uarts[i]->getIrqSource() == NULL) {
+            uarts[i]->setIrqSource(irqSource);
+        }
+
+        if (uarts[i]->serviceIIR(iir[i]) < 0) {
+            errorFlag = true;
+            errorMessage = uarts[i]->getErrorMessage();
+            return -1;
+        }
+        serviced++;
+    }
+
+    next = (next + 1) % count;
+    services += serviced;
+
+    return serviced;
+}
+
+
+/**
+ * @~english
+ * @brief Get the shortest poll timeout of the chips, polling their RX FIFO
+ * (see gnublin_module_sc16is7x0::setRxPolling) or with data left by the
+ * budget (0).
+ *
+ * @return The poll timeout in ms or -1 when no chip is polling.
+ */
+int sc16is7x0_scheduler::getPollTimeout(void) {
+
+    int timeout = -1;
+
+    for (int i = 0; i < count; i++) {
+        int pollTimeout = uarts[i]->getPollTimeout();
+        if ((pollTimeout >= 0) && ((timeout < 0) || (pollTimeout < timeout))) {
+            timeout = pollTimeout;
+        }
+    }
+
+    return timeout;
+}
+
+
+/**
+ * @~english
+ * @brief Get the number of passes done.
+ *
+ * @return The number of passes.
+ */
+unsigned long sc16is7x0_scheduler::getPasses(void) {
+
+    return passes;
+}
+
+
+/**
+ * @~english
+ * @brief Get the number of chips serviced.
+ *
+ * @return The number of services.
+ */
+unsigned long sc16is7x0_scheduler::getServices(void) {
+
+    return services;
+}
+
+
+/**
+ * @~english
+ * @brief Read the IIR of all the chips. The chips on the same bus are read
+ * in a single transaction.
+ *
+ * @param iir The IIR values, one per chip.
+ * @return -1 on error and 1 on success.
+ */
+int sc16is7x0_scheduler::scan(unsigned char *iir) {
+
+    sc16is7x0_transport *transports[SCHEDULER_MAX_UARTS];
+    unsigned char values[SCHEDULER_MAX_UARTS];
+    int index[SCHEDULER_MAX_UARTS];
+    bool scanned[SCHEDULER_MAX_UARTS];
+
+    for (int i = 0; i < count; i++) {
+        scanned[i] = false;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (scanned[i]) {
+            continue;
+        }
+
+        sc16is7x0_transport *transport = uarts[i]->getTransport();
+        std::string bus = transport->getBus();
+        int n = 0;
+
+        /* The chips on the same bus. */
+        for (int j = i; j < count; j++) {
+            if (!scanned[j] && ((j == i) || (!bus.empty() && (uarts[j]->getTransport()->getBus() == bus)))) {
+                transports[n] = uarts[j]->getTransport();
+                index[n] = j;
+                scanned[j] = true;
+                n++;
+            }
+        }
+
+        if (transport->scan(transports, n, IIR, values) < 0) {
+            errorFlag = true;
+            errorMessage = transport->getErrorMessage();
+            return -1;
+        }
+
+        for (int k = 0; k < n; k++) {
+            iir[index[k]] = values[k];
+        }
+    }
+
+    return 1;
+}
+
+/* -------------------------------------------------------------------------- */
+
+// 
+// module_sc16is7x0_scheduler.cpp ends here
@@ -0,0 +1,113 @@
+/* module_sc16is7x0_scheduler.h --- 
+ * 
+ * Filename     : module_sc16is7x0_scheduler.h
+ * Description  : Class for servicing many SC16IS7x0 chips sharing IRQ lines and buses.
+ * Author       : Christophe Burki
+ * Maintainer   : Christophe Burki
+ * Created      : Sat Oct 17 16:20:45 2026
+ * Version      : 
+ * Last-Updated : 
+ *           By : 
+ *     Update # : 0
+ * URL          : 
+ * Keywords     : 
+ * Compatibility: 
+ * 
+ */
+
+/* Commentary   : 
+ *
+ * Several chips could be attached to an I2C bus (addresses 0x48 to 0x4d)
+ * and several buses could be used. Their IRQ lines are usually wired
+ * together. The scheduler owns the chips and is registered
+ * in a reactor in place of them.
+ *
+ * Each pass of the scheduler reads the IIR of all the chips, the chips on
+ * the same I2C bus in a single transaction (see sc16is7x0_transport::scan).
+ * Only the chips with a pending interrupt are then serviced, in a round
+ * robin order starting with the next chip at each pass. The number of
+ * bytes moved per chip and per pass is limited by the budget so that a
+ * busy chip does not starve the others. A chip with work left is serviced
+ * again by the next pass, the reactor calls pollInt until no chip has a
+ * pending interrupt. The chips polling their RX FIFO (see setRxPolling)
+ * are polled by each pass.
+ *
+ */
+
+/* Change log:
+ * 
+ * 
+ */
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as 
+ * published by the Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file LICENSE.  If not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth
+ * ;; Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* Code         : */
+
+#ifndef GNUBLIN_MODULE_SC16IS7x0_SCHEDULER
+#define GNUBLIN_MODULE_SC16IS7x0_SCHEDULER
+
+/* -------------------------------------------------------------------------- */
+
+#include "gnublin.h"
+#include "module_irq.h"
+#include "module_sc16is7x0.h"
+
+/* -------------------------------------------------------------------------- */
+
+#define SCHEDULER_MAX_UARTS      16         /* Maximum number of chips. */
+#define SCHEDULER_DEFAULT_BUDGET FIFO_SIZE  /* Default number of bytes per chip and per pass. */
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @class sc16is7x0_scheduler
+ * @~english
+ * @brief Service the interrupts of many chips with batched IIR scans and
+ * per chip byte budgets.
+ */
+class sc16is7x0_scheduler : public gnublin_irq_handler {
+
+ protected :
+    bool errorFlag;
+    std::string errorMessage;
+
+    gnublin_module_sc16is7x0 *uarts[SCHEDULER_MAX_UARTS];
+    int count;
+    int next;              /* First chip serviced by the next pass. */
+    unsigned int budget;
+    unsigned long passes;
+    unsigned long services;
+
+    int scan(unsigned char *iir);
+
+ public :
+    sc16is7x0_scheduler(unsigned int budget = SCHEDULER_DEFAULT_BUDGET);
+    const char* getErrorMessage(void);
+    bool fail(void);
+    int add(gnublin_module_sc16is7x0 *uart);
+    int remove(gnublin_module_sc16is7x0 *uart);
+    int setBudget(unsigned int bytes);
+    int pollInt(void);
+    int getPollTimeout(void);
+    unsigned long getPasses(void);
+    unsigned long getServices(void);
+};
+
+/* -------------------------------------------------------------------------- */
+
+#endif
+
+/* module_sc16is7x0_scheduler.h ends here */
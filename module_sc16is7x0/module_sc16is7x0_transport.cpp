@@ -0,0 +1,1139 @@
+// module_sc16is7x0_transport.cpp --- 
+// 
+// Filename     : module_sc16is7x0_transport.cpp
+// Description  : Classes for accessing the SC16IS7x0 registers via I2C or SPI.
+// Author       : Christophe Burki
+// Maintainer   : Christophe Burki
+// Created      : Sat Oct 17 11:05:12 2026
+// Version      : 1.0.0
+// Last-Updated : 
+//           By : 
+//     Update # : 0
+// URL          : 
+// Keywords     : 
+// Compatibility: 
+// 
+// 
+
+// Commentary   : 
+// 
+// 
+// 
+// 
+
+// Change log:
+// 
+// 
+// 
+// 
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 3 as
+// published by the Free Software Foundation.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program; see the file LICENSE.  If not, write to the
+// Free Software Foundation, Inc., 51 Franklin Street, Fifth
+// ;; Floor, Boston, MA 02110-1301, USA.
+// 
+// 
+
+// Code         :
+
+/* -------------------------------------------------------------------------- */
+
+#include "module_sc16is7x0.h"
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @~english
+ * @brief Create the transport.
+ */
+sc16is7x0_transport::sc16is7x0_transport(void) {
+
+    errorFlag = false;
+    transactions = 0;
+}
+
+
+/**
+ * @~english
+ * @brief Destroy the transport.
+ */
+sc16is7x0_transport::~sc16is7x0_transport(void) {
+}
+
+
+/**
+ * @~english
+ * @brief Get the last error message.
+ *
+ * @return The error message as c-string.
+ */
+const char* sc16is7x0_transport::getErrorMessage(void) {
+
+    return errorMessage.c_str();
+}
+
+
+/**
+ * @~english
+ * @brief Return whether the action fail or not.
+ *
+ * @return A boolean value indicating if the action fail or not.
+ */
+bool sc16is7x0_transport::fail(void) {
+
+    return errorFlag;
+}
+
+
+/**
+ * @~english
+ * @brief Write the given bytes to a register.
+ *
+ * @param reg The register index.
+ * @param buffer The bytes to write.
+ * @param len The number of bytes to write.
+ * @return -1 on error and 1 on success.
+ */
+int sc16is7x0_transport::send(unsigned char reg, unsigned char *buffer, int len) {
+
+    sc16is7x0_xfer xfer;
+
+    xfer.reg = reg;
+    xfer.read = 0;
+    xfer.buffer = buffer;
+    xfer.len = len;
+
+    return transfer(&xfer, 1);
+}
+
+
+/**
+ * @~english
+ * @brief Read bytes from a register.
+ *
+ * @param reg The register index.
+ * @param buffer The buffer receiving the bytes.
+ * @param len The number of bytes to read.
+ * @return -1 on error and 1 on success.
+ */
+int sc16is7x0_transport::receive(unsigned char reg, unsigned char *buffer, int len) {
+
+    sc16is7x0_xfer xfer;
+
+    xfer.reg = reg;
+    xfer.read = 1;
+    xfer.buffer = buffer;
+    xfer.len = len;
+
+    return transfer(&xfer, 1);
+}
+
+
+/**
+ * @~english
+ * @brief Execute a sequence of register accesses in a single transaction.
+ *
+ * @param xfers The register accesses.
+ * @param count The number of accesses (at most TRANSPORT_MAX_XFERS).
+ * @return -1 on error and 1 on success.
+ */
+int sc16is7x0_transport::transfer(sc16is7x0_xfer *xfers, int count) {
+
+    errorFlag = false;
+
+    if ((count < 1) || (count > TRANSPORT_MAX_XFERS)) {
+        errorFlag = true;
+        errorMessage = "Invalid number of register accesses\n";
+        return -1;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if ((xfers[i].len == 0) || (xfers[i].len > TRANSPORT_MAX_LEN)) {
+            errorFlag = true;
+            errorMessage = "Invalid register access length\n";
+            return -1;
+        }
+    }
+
+    transactions++;
+    return execute(xfers, count);
+}
+
+
+/**
+ * @~english
+ * @brief Get the bus shared by the transports that could be scanned in a
+ * single transaction (see scan).
+ *
+ * @return The bus or an empty string when the transport could not be
+ * scanned with others.
+ */
+std::string sc16is7x0_transport::getBus(void) {
+
+    return "";
+}
+
+
+/**
+ * @~english
+ * @brief Read the same register of several chips. The register of each
+ * transport is read in its own transaction.
+ *
+ * @param transports The transports of the chips, this transport included.
+ * @param count The number of transports.
+ * @param reg The register to read.
+ * @param values The values read, one per transport.
+ * @return -1 on error and 1 on success.
+ */
+int sc16is7x0_transport::scan(sc16is7x0_transport **transports, int count, unsigned char reg, unsigned char *values) {
+
+    errorFlag = false;
+
+    for (int i = 0; i < count; i++) {
+        if (transports[i]->receive(reg, values + i, 1) < 0) {
+            errorFlag = true;
+            errorMessage = transports[i]->getErrorMessage();
+            return -1;
+        }
+    }
+
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Get the number of transactions executed.
+ *
+ * @return The number of transactions since the creation or the last reset.
+ */
+unsigned long sc16is7x0_transport::getTransactions(void) {
+
+    return transactions;
+}
+
+
+/**
+ * @~english
+ * @brief Reset the number of transactions executed.
+ */
+void sc16is7x0_transport::resetTransactions(void) {
+
+    transactions = 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @~english
+ * @brief Set the given i2c address to 0x20 and the given i2c file to /dev/i2c-1.
+ *
+ * @param address The i2c address.
+ * @param filename The i2c device file.
+ */
+sc16is7x0_transport_i2c::sc16is7x0_transport_i2c(int address, std::string filename) {
+
+    fd = -1;
+    setAddress(address);
+    setDevicefile(filename);
+}
+
+
+/**
+ * @~english
+ * @brief Close the i2c device file.
+ */
+sc16is7x0_transport_i2c::~sc16is7x0_transport_i2c(void) {
+
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+
+/**
+ * @~english
+ * @brief Set the i2c address.
+ *
+ * @param address The address to set.
+ */
+void sc16is7x0_transport_i2c::setAddress(int address) {
+
+    this->address = address;
+}
+
+
+/**
+ * @~english
+ * @brief Set the i2c device file. The file is opened on the next transfer.
+ *
+ * @param filename The i2c device filename.
+ */
+void sc16is7x0_transport_i2c::setDevicefile(std::string filename) {
+
+    devicefile = filename;
+
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+
+/**
+ * @~english
+ * @brief Execute the register accesses in a combined I2C transaction
+ * (I2C_RDWR). The accesses are separated by repeated start conditions. A
+ * write is a single message starting with the subaddress, a read is the
+ * subaddress message followed by a read message.
+ *
+ * @param xfers The register accesses.
+ * @param count The number of accesses.
+ * @return -1 on error and 1 on success.
+ */
+int sc16is7x0_transport_i2c::execute(sc16is7x0_xfer *xfers, int count) {
+
+    unsigned char data[TRANSPORT_MAX_XFERS][TRANSPORT_MAX_LEN + 1];
+    struct i2c_msg msgs[TRANSPORT_MAX_XFERS * 2];
+    struct i2c_rdwr_ioctl_data rdwr;
+    int nmsgs = 0;
+
+    if (fd < 0) {
+        fd = open(devicefile.c_str(), O_RDWR);
+        if (fd < 0) {
+            errorFlag = true;
+            errorMessage = "open (" + devicefile + ") Error\n";
+            return -1;
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        data[i][0] = xfers[i].reg << 3;
+
+        msgs[nmsgs].addr = address;
+        msgs[nmsgs].flags = 0;
+        msgs[nmsgs].buf = data[i];
+        if (xfers[i].read) {
+            msgs[nmsgs].len = 1;
+            nmsgs++;
+
+            msgs[nmsgs].addr = address;
+            msgs[nmsgs].flags = I2C_M_RD;
+            msgs[nmsgs].len = xfers[i].len;
+            msgs[nmsgs].buf = xfers[i].buffer;
+        }
+        else {
+            memcpy(data[i] + 1, xfers[i].buffer, xfers[i].len);
+            msgs[nmsgs].len = xfers[i].len + 1;
+        }
+        nmsgs++;
+    }
+
+    rdwr.msgs = msgs;
+    rdwr.nmsgs = nmsgs;
+    if (ioctl(fd, I2C_RDWR, &rdwr) < 0) {
+        errorFlag = true;
+        errorMessage = "ioctl (I2C_RDWR) Error\n";
+        return -1;
+    }
+
+    return 1;
+}
+
+
+
+/**
+ * @~english
+ * @brief Get the i2c device file, the transports with the same device file
+ * are scanned in a single transaction.
+ *
+ * @return The i2c device file.
+ */
+std::string sc16is7x0_transport_i2c::getBus(void) {
+
+    return devicefile;
+}
+
+
+/**
+ * @~english
+ * @brief Read the same register of several chips on the same bus in a
+ * single I2C_RDWR transaction (at most TRANSPORT_MAX_XFERS chips per
+ * transaction). The transports must all be I2C transports on the bus of
+ * this transport (see getBus).
+ *
+ * @param transports The transports of the chips, this transport included.
+ * @param count The number of transports.
+ * @param reg The register to read.
+ * @param values The values read, one per transport.
+ * @return -1 on error and 1 on success.
+ */
+int sc16is7x0_transport_i2c::scan(sc16is7x0_transport **transports, int count, unsigned char reg, unsigned char *values) {
+
+    errorFlag = false;
+    unsigned char subaddress = reg << 3;
+    struct i2c_msg msgs[TRANSPORT_MAX_XFERS * 2];
+    struct i2c_rdwr_ioctl_data rdwr;
+
+    if (fd < 0) {
+        fd = open(devicefile.c_str(), O_RDWR);
+        if (fd < 0) {
+            errorFlag = true;
+            errorMessage = "open (" + devicefile + ") Error\n";
+            return -1;
+        }
+    }
+
+    for (int first = 0; first < count; first += TRANSPORT_MAX_XFERS) {
+        int nmsgs = 0;
+
+        for (int i = first; (i < count) && (i < first + TRANSPORT_MAX_XFERS); i++) {
+            sc16is7x0_transport_i2c *transport = static_cast<sc16is7x0_transport_i2c *>(transports[i]);
+
+            msgs[nmsgs].addr = transport->address;
+            msgs[nmsgs].flags = 0;
+            msgs[nmsgs].len = 1;
+            msgs[nmsgs].buf = &subaddress;
+            nmsgs++;
+
+            msgs[nmsgs].addr = transport->address;
+            msgs[nmsgs].flags = I2C_M_RD;
+            msgs[nmsgs].len = 1;
+            msgs[nmsgs].buf = values + i;
+            nmsgs++;
+        }
+
+        rdwr.msgs = msgs;
+        rdwr.nmsgs = nmsgs;
+        transactions++;
+        if (ioctl(fd, I2C_RDWR, &rdwr) < 0) {
+            errorFlag = true;
+            errorMessage = "ioctl (I2C_RDWR) Error\n";
+            return -1;
+        }
+    }
+
+    return 1;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @~english
+ * @brief Set the spi device file and the clock speed.
+ *
+ * @param filename The spidev device file.
+ * @param speed The SPI clock speed in Hz.
+ */
+sc16is7x0_transport_spi::sc16is7x0_transport_spi(std::string filename, unsigned int speed) {
+
+    fd = -1;
+    this->speed = speed;
+    setDevicefile(filename);
+}
+
+
+/**
+ * @~english
+ * @brief Close the spi device file.
+ */
+sc16is7x0_transport_spi::~sc16is7x0_transport_spi(void) {
+
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+
+/**
+ * @~english
+ * @brief Set the spi device file. The file is opened and configured on the
+ * next transfer.
+ *
+ * @param filename The spidev device filename.
+ */
+void sc16is7x0_transport_spi::setDevicefile(std::string filename) {
+
+    devicefile = filename;
+
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+
+/**
+ * @~english
+ * @brief Set the SPI clock speed.
+ *
+ * @param speed The clock speed in Hz.
+ */
+void sc16is7x0_transport_spi::setSpeed(unsigned int speed) {
+
+    this->speed = speed;
+}
+
+
+/**
+ * @~english
+ * @brief Execute the register accesses with a single SPI_IOC_MESSAGE. Each
+ * access is the register address byte followed by the data. The chip
+ * select is released between the accesses.
+ *
+ * @param xfers The register accesses.
+ * @param count The number of accesses.
+ * @return -1 on error and 1 on success.
+ */
+int sc16is7x0_transport_spi::execute(sc16is7x0_xfer *xfers, int count) {
+
+    unsigned char address[TRANSPORT_MAX_XFERS];
+    struct spi_ioc_transfer msgs[TRANSPORT_MAX_XFERS * 2];
+    unsigned char mode = SPI_MODE_0;
+    unsigned char bits = 8;
+
+    if (fd < 0) {
+        fd = open(devicefile.c_str(), O_RDWR);
+        if (fd < 0) {
+            errorFlag = true;
+            errorMessage = "open (" + devicefile + ") Error\n";
+            return -1;
+        }
+
+        if ((ioctl(fd, SPI_IOC_WR_MODE, &mode) < 0) || (ioctl(fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0)) {
+            errorFlag = true;
+            errorMessage = "ioctl (SPI_IOC_WR_MODE) Error\n";
+            close(fd);
+            fd = -1;
+            return -1;
+        }
+    }
+
+    memset(msgs, 0, sizeof(msgs));
+    for (int i = 0; i < count; i++) {
+        struct spi_ioc_transfer *msg = msgs + (i * 2);
+
+        address[i] = (xfers[i].reg << 3) | (xfers[i].read ? 0x80 : 0x00);
+
+        msg[0].tx_buf = (unsigned long)(address + i);
+        msg[0].len = 1;
+        msg[0].speed_hz = speed;
+        msg[0].bits_per_word = 8;
+
+        if (xfers[i].read) {
+            msg[1].rx_buf = (unsigned long)xfers[i].buffer;
+        }
+        else {
+            msg[1].tx_buf = (unsigned long)xfers[i].buffer;
+        }
+        msg[1].len = xfers[i].len;
+        msg[1].speed_hz = speed;
+        msg[1].bits_per_word = 8;
+
+        /* Release the chip select between the accesses. */
+        msg[1].cs_change = (i < count - 1) ? 1 : 0;
+    }
+
+    if (ioctl(fd, SPI_IOC_MESSAGE(count * 2), msgs) < 0) {
+        errorFlag = true;
+        errorMessage = "ioctl (SPI_IOC_MESSAGE) Error\n";
+        return -1;
+    }
+
+    return 1;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @~english
+ * @brief Create a simulated chip with its registers at their reset values.
+ */
+sc16is7x0_transport_mock::sc16is7x0_transport_mock(void) {
+
+    reset();
+}
+
+
+/**
+ * @~english
+ * @brief Set the registers to their reset values and empty the FIFO.
+ */
+void sc16is7x0_transport_mock::reset(void) {
+
+    memset(regs, 0, sizeof(regs));
+    regs[LCR] = 0x1d;
+    regs[SPR] = 0xff;
+    dll = 0;
+    dlh = 0;
+    efr = 0;
+    xon[0] = xon[1] = 0;
+    xoff[0] = xoff[1] = 0;
+    tcr = 0;
+    tlr = 0;
+    fcr = 0;
+    thrArmed = 0;
+    txStopped = 0;
+    xoffReceived = 0;
+    xoffSent = 0;
+    overrun = 0;
+    msr = MSR_CTS;
+    ctsInactive = 0;
+
+    rxHead = 0;
+    rxCount = 0;
+    txHead = 0;
+    txCount = 0;
+}
+
+
+/**
+ * @~english
+ * @brief Put data in the RX FIFO as if received on the line.
+ *
+ * @param buffer The data received.
+ * @param len The length of the data.
+ * @return The number of bytes put in the FIFO. The others are lost
+ * (overrun).
+ */
+int sc16is7x0_transport_mock::inject(const char *buffer, unsigned int len) {
+
+    unsigned int count = 0;
+
+    while ((count < len) && (rxCount < TRANSPORT_MAX_LEN)) {
+        lineReceive(buffer[count]);
+        count++;
+    }
+
+    if (count < len) {
+        overrun = 1;
+    }
+
+    return count;
+}
+
+
+/**
+ * @~english
+ * @brief Put data in the RX FIFO as if received on the line with errors.
+ *
+ * @param buffer The data received.
+ * @param len The length of the data.
+ * @param errors The errors of each byte (LSR_PARITY, LSR_FRAMING,
+ * LSR_BREAK).
+ * @return The number of bytes put in the FIFO.
+ */
+int sc16is7x0_transport_mock::injectError(const char *buffer, unsigned int len, unsigned char errors) {
+
+    unsigned int count = 0;
+
+    while ((count < len) && (rxCount < TRANSPORT_MAX_LEN)) {
+        lineReceive(buffer[count], errors & LSR_ERRORS);
+        count++;
+    }
+
+    if (count < len) {
+        overrun = 1;
+    }
+
+    return count;
+}
+
+
+/**
+ * @~english
+ * @brief Receive an address byte (parity bit set) as sent by the master of
+ * a multidrop bus. With the automatic address detection, the receiver is
+ * enabled when the address matches XOFF2 and disabled otherwise. The
+ * address byte received is flagged with a parity error.
+ *
+ * @param address The address.
+ */
+void sc16is7x0_transport_mock::injectAddress(unsigned char address) {
+
+    if ((regs[EFCRF] & CONF_MULTIDROP) && (efr & CONF_SPECIAL_CHAR)) {
+        if (address != xoff[1]) {
+            regs[EFCRF] |= CONF_RX_DISABLE;
+            return;
+        }
+        regs[EFCRF] &= ~CONF_RX_DISABLE;
+    }
+
+    lineReceive(address, LSR_PARITY);
+}
+
+
+/**
+ * @~english
+ * @brief Set the state of the CTS input as driven by the peer.
+ *
+ * @param active 1 when the peer is ready to receive (CTS LOW) and 0
+ * otherwise.
+ */
+void sc16is7x0_transport_mock::setCts(int active) {
+
+    unsigned char cts = active ? MSR_CTS : 0;
+
+    if ((msr & MSR_CTS) != cts) {
+        msr = (msr & ~MSR_CTS) | cts | MSR_DELTA_CTS;
+        if (!active) {
+            ctsInactive = 1;
+        }
+    }
+}
+
+
+/**
+ * @~english
+ * @brief Take data from the TX FIFO as if transmitted on the line. Nothing
+ * is transmitted after a XOFF is received or while CTS is inactive with the
+ * automatic CTS flow control.
+ *
+ * @param buffer The buffer receiving the data transmitted.
+ * @param len The size of the buffer.
+ * @return The number of bytes transmitted.
+ */
+int sc16is7x0_transport_mock::drain(char *buffer, unsigned int len) {
+
+    unsigned int count = 0;
+
+    if (txStopped) {
+        /* XOFF received. */
+        return 0;
+    }
+
+    if ((efr & CONF_FLOW_CTS) && !(msr & MSR_CTS)) {
+        /* CTS inactive. */
+        return 0;
+    }
+
+    while ((count < len) && (txCount > 0)) {
+        buffer[count] = txFifo[txHead];
+        txHead = (txHead + 1) % TRANSPORT_MAX_LEN;
+        txCount--;
+        count++;
+    }
+
+    return count;
+}
+
+
+/**
+ * @~english
+ * @brief Get the number of bytes in the RX FIFO.
+ *
+ * @return The number of bytes waiting to be read.
+ */
+int sc16is7x0_transport_mock::rxLevel(void) {
+
+    return rxCount;
+}
+
+
+/**
+ * @~english
+ * @brief Get the number of bytes in the TX FIFO.
+ *
+ * @return The number of bytes waiting to be transmitted.
+ */
+int sc16is7x0_transport_mock::txLevel(void) {
+
+    return txCount;
+}
+
+
+/**
+ * @~english
+ * @brief Return the state of the IRQ line.
+ *
+ * @return 1 when an interrupt is pending and 0 otherwise.
+ */
+int sc16is7x0_transport_mock::isIntPending(void) {
+
+    return ((interruptId() & 0x01) == 0);
+}
+
+
+/**
+ * @~english
+ * @brief Execute the register accesses on the simulated chip.
+ *
+ * @param xfers The register accesses.
+ * @param count The number of accesses.
+ * @return 1.
+ */
+int sc16is7x0_transport_mock::execute(sc16is7x0_xfer *xfers, int count) {
+
+    for (int i = 0; i < count; i++) {
+        for (unsigned int j = 0; j < xfers[i].len; j++) {
+            if (xfers[i].read) {
+                xfers[i].buffer[j] = readRegister(xfers[i].reg);
+            }
+            else {
+                writeRegister(xfers[i].reg, xfers[i].buffer[j]);
+            }
+        }
+    }
+
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Read a register of the simulated chip.
+ *
+ * @param reg The register index.
+ * @return The value of the register.
+ */
+unsigned char sc16is7x0_transport_mock::readRegister(unsigned char reg) {
+
+    unsigned char lcr = regs[LCR];
+    int tcrTlr = (regs[MCR] & (1 << 2)) && (efr & (1 << 4));
+    unsigned char value;
+
+    if ((lcr == 0xbf) && (reg >= EFR) && (reg <= XOFF2) && (reg != LCR)) {
+        switch (reg) {
+        case EFR : return efr;
+        case XON1 : return xon[0];
+        case XON2 : return xon[1];
+        case XOFF1 : return xoff[0];
+        case XOFF2 : return xoff[1];
+        }
+    }
+
+    if ((lcr & (1 << 7)) && (reg == DLL)) {
+        return dll;
+    }
+    if ((lcr & (1 << 7)) && (reg == DLH)) {
+        return dlh;
+    }
+
+    switch (reg) {
+    case RHR :
+        if (rxCount == 0) {
+            return 0;
+        }
+        value = rxFifo[rxHead];
+        rxHead = (rxHead + 1) % TRANSPORT_MAX_LEN;
+        rxCount--;
+        if (xoffSent && (rxCount <= ((tcr >> 4) & 0x0f) * 4)) {
+            /* Resume level reached. */
+            lineTransmit((efr & 0x08) ? xon[0] : xon[1]);
+            xoffSent = 0;
+        }
+        return value;
+    case IIR :
+        value = interruptId();
+        if ((value & 0x3e) == INT_THR) {
+            thrArmed = 0;
+        }
+        if ((value & 0x3e) == INT_XOFF) {
+            xoffReceived = 0;
+        }
+        if ((value & 0x3e) == INT_CTSRTS) {
+            ctsInactive = 0;
+        }
+        return value;
+    case LSR :
+        value = (rxCount > 0) ? (LSR_DATA | rxErrors[rxHead]) : 0x00;
+        if (txCount == 0) {
+            value |= LSR_THR_EMPTY | LSR_TX_EMPTY;
+        }
+        if (overrun) {
+            value |= LSR_OVERRUN;
+            overrun = 0;
+        }
+        for (unsigned int i = 0; i < rxCount; i++) {
+            if (rxErrors[(rxHead + i) % TRANSPORT_MAX_LEN]) {
+                value |= LSR_FIFO_ERROR;
+                break;
+            }
+        }
+        return value;
+    case MSR :
+        if (tcrTlr) {
+            return tcr;
+        }
+        value = msr;
+        msr &= ~MSR_DELTAS;
+        return value;
+    case SPR :
+        return tcrTlr ? tlr : regs[SPR];
+    case TXLVL :
+        return TRANSPORT_MAX_LEN - txCount;
+    case RXLVL :
+        return rxCount;
+    default :
+        return regs[reg & 0x0f];
+    }
+}
+
+
+/**
+ * @~english
+ * @brief Write a register of the simulated chip.
+ *
+ * @param reg The register index.
+ * @param value The value to write.
+ */
+void sc16is7x0_transport_mock::writeRegister(unsigned char reg, unsigned char value) {
+
+    unsigned char lcr = regs[LCR];
+    int tcrTlr = (regs[MCR] & (1 << 2)) && (efr & (1 << 4));
+
+    if ((lcr == 0xbf) && (reg >= EFR) && (reg <= XOFF2) && (reg != LCR)) {
+        switch (reg) {
+        case EFR : efr = value; return;
+        case XON1 : xon[0] = value; return;
+        case XON2 : xon[1] = value; return;
+        case XOFF1 : xoff[0] = value; return;
+        case XOFF2 : xoff[1] = value; return;
+        }
+    }
+
+    if ((lcr & (1 << 7)) && (reg == DLL)) {
+        dll = value;
+        return;
+    }
+    if ((lcr & (1 << 7)) && (reg == DLH)) {
+        dlh = value;
+        return;
+    }
+
+    switch (reg) {
+    case THR :
+        if (regs[MCR] & (1 << 4)) {
+            /* Loopback, the data is received back. */
+            lineReceive(value);
+        }
+        else {
+            lineTransmit(value);
+        }
+        thrArmed = 1;
+        break;
+    case FCR :
+        fcr = value;
+        if (value & (1 << 1)) {
+            rxHead = 0;
+            rxCount = 0;
+        }
+        if (value & (1 << 2)) {
+            txHead = 0;
+            txCount = 0;
+        }
+        break;
+    case IER :
+        if ((value & CONF_INT_THREN) && !(regs[IER] & CONF_INT_THREN)) {
+            thrArmed = 1;
+        }
+        regs[IER] = value;
+        break;
+    case MSR :
+        if (tcrTlr) {
+            tcr = value;
+        }
+        break;
+    case SPR :
+        if (tcrTlr) {
+            tlr = value;
+        }
+        else {
+            regs[SPR] = value;
+        }
+        break;
+    case IOCTRL :
+        if (value & (1 << 3)) {
+            /* Software reset. */
+            reset();
+        }
+        else {
+            regs[IOCTRL] = value;
+        }
+        break;
+    case LSR :
+    case TXLVL :
+    case RXLVL :
+        /* Read only. */
+        break;
+    default :
+        regs[reg & 0x0f] = value;
+        break;
+    }
+}
+
+
+/**
+ * @~english
+ * @brief Put a byte in the TX FIFO.
+ *
+ * @param value The byte to transmit.
+ */
+void sc16is7x0_transport_mock::lineTransmit(unsigned char value) {
+
+    if (txCount < TRANSPORT_MAX_LEN) {
+        txFifo[(txHead + txCount) % TRANSPORT_MAX_LEN] = value;
+        txCount++;
+    }
+}
+
+
+/**
+ * @~english
+ * @brief Receive a byte. The software flow control characters are not put
+ * in the RX FIFO. A XOFF is sent when the halt level is reached. The
+ * special character raises the XOFF interrupt. Nothing is received while
+ * the receiver is disabled (multidrop mode).
+ *
+ * @param value The byte received.
+ * @param errors The errors of the byte (LSR[4:2]).
+ */
+void sc16is7x0_transport_mock::lineReceive(unsigned char value, unsigned char errors) {
+
+    if (regs[EFCRF] & CONF_RX_DISABLE) {
+        /* Receiver disabled (multidrop mode). */
+        return;
+    }
+
+    if (((efr & 0x02) && (value == xoff[0])) || ((efr & 0x01) && (value == xoff[1]))) {
+        txStopped = 1;
+        xoffReceived = 1;
+        return;
+    }
+
+    if (((efr & 0x02) && (value == xon[0])) || ((efr & 0x01) && (value == xon[1]))) {
+        txStopped = 0;
+        return;
+    }
+
+    if (rxCount == TRANSPORT_MAX_LEN) {
+        /* Overrun. */
+        overrun = 1;
+        return;
+    }
+
+    rxFifo[(rxHead + rxCount) % TRANSPORT_MAX_LEN] = value;
+    rxErrors[(rxHead + rxCount) % TRANSPORT_MAX_LEN] = errors;
+    rxCount++;
+
+    if ((efr & CONF_SPECIAL_CHAR) && !(regs[EFCRF] & CONF_MULTIDROP) && (value == xoff[1])) {
+        /* Special character, kept in the RX FIFO. */
+        xoffReceived = 1;
+    }
+
+    if ((efr & 0x0c) && !xoffSent && (tcr & 0x0f) && (rxCount >= (tcr & 0x0f) * 4u)) {
+        /* Halt level reached. */
+        lineTransmit((efr & 0x08) ? xoff[0] : xoff[1]);
+        xoffSent = 1;
+    }
+}
+
+
+/**
+ * @~english
+ * @brief Compute the value of the IIR register from the state of the FIFO
+ * and the enabled interrupts.
+ *
+ * @return The value of the IIR register.
+ */
+unsigned char sc16is7x0_transport_mock::interruptId(void) {
+
+    unsigned char fifo = (fcr & 0x01) ? 0xc0 : 0x00;
+    unsigned char ier = regs[IER];
+
+    if (ier & CONF_INT_RLSEN) {
+        if (overrun) {
+            return fifo | INT_RLSE;
+        }
+        for (unsigned int i = 0; i < rxCount; i++) {
+            if (rxErrors[(rxHead + i) % TRANSPORT_MAX_LEN]) {
+                return fifo | INT_RLSE;
+            }
+        }
+    }
+
+    if ((ier & CONF_INT_RHREN) && (rxCount > 0)) {
+        if (rxCount >= rxTrigger()) {
+            return fifo | INT_RHR;
+        }
+
+        /* The data below the trigger level is reported after a timeout. */
+        return fifo | INT_RTOUT;
+    }
+
+    if ((ier & CONF_INT_THREN) && thrArmed && (TRANSPORT_MAX_LEN - txCount >= txTrigger())) {
+        return fifo | INT_THR;
+    }
+
+    if ((ier & CONF_INT_MSEN) && (msr & MSR_DELTAS)) {
+        return fifo | INT_MODEM;
+    }
+
+    if ((ier & CONF_INT_XOFFEN) && xoffReceived) {
+        return fifo | INT_XOFF;
+    }
+
+    if ((ier & CONF_INT_CTSEN) && ctsInactive) {
+        return fifo | INT_CTSRTS;
+    }
+
+    return fifo | 0x01;
+}
+
+
+/**
+ * @~english
+ * @brief Get the RX trigger level in bytes (TLR or FCR[7:6]).
+ *
+ * @return The RX trigger level.
+ */
+unsigned int sc16is7x0_transport_mock::rxTrigger(void) {
+
+    static const unsigned int levels[4] = {8, 16, 56, 60};
+
+    if (!(fcr & 0x01)) {
+        return 1;
+    }
+
+    if (tlr & 0xf0) {
+        return ((tlr >> 4) & 0x0f) * 4;
+    }
+
+    return levels[(fcr >> 6) & 0x03];
+}
+
+
+/**
+ * @~english
+ * @brief Get the TX trigger level in spaces (TLR or FCR[5:4]).
+ *
+ * @return The TX trigger level.
+ */
+unsigned int sc16is7x0_transport_mock::txTrigger(void) {
+
+    static const unsigned int levels[4] = {8, 16, 32, 56};
+
+    if (!(fcr & 0x01)) {
+        return TRANSPORT_MAX_LEN;
+    }
+
+    if (tlr & 0x0f) {
+        return (tlr & 0x0f) * 4;
+    }
+
+    return levels[(fcr >> 4) & 0x03];
+}
+
+/* -------------------------------------------------------------------------- */
+
+// 
+// module_sc16is7x0_transport.cpp ends here
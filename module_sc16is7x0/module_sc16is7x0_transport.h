@@ -0,0 +1,240 @@
+/* module_sc16is7x0_transport.h --- 
+ * 
+ * Filename     : module_sc16is7x0_transport.h
+ * Description  : Classes for accessing the SC16IS7x0 registers via I2C or SPI.
+ * Author       : Christophe Burki
+ * Maintainer   : Christophe Burki
+ * Created      : Sat Oct 17 11:02:37 2026
+ * Version      : 
+ * Last-Updated : 
+ *           By : 
+ *     Update # : 0
+ * URL          : 
+ * Keywords     : 
+ * Compatibility: 
+ * 
+ */
+
+/* Commentary   : 
+ *
+ * The register index is encoded in the bits 6:3 of the first byte sent to
+ * the chip (I2C subaddress or SPI register address byte). The SPI read
+ * accesses set the bit 7 of this byte. The channel bits 2:1 are always 0
+ * for the single UART chips. (See section 10.4 and 11.5 of the SC16IS750
+ * datasheet)
+ *
+ * A transfer is a sequence of register accesses executed with a single
+ * system call (I2C_RDWR or SPI_IOC_MESSAGE). Each transfer counts as one
+ * transaction.
+ *
+ * The same register of several chips could be read at once with scan. The
+ * I2C transport reads the chips attached to the same bus in a single
+ * I2C_RDWR transaction (one message pair per chip address).
+ *
+ * The mock transport simulates the registers and the FIFO of a chip so that
+ * the module could be used without hardware.
+ *
+ */
+
+/* Change log:
+ * 
+ * 
+ */
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as 
+ * published by the Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file LICENSE.  If not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth
+ * ;; Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* Code         : */
+
+#ifndef GNUBLIN_MODULE_SC16IS7x0_TRANSPORT
+#define GNUBLIN_MODULE_SC16IS7x0_TRANSPORT
+
+/* -------------------------------------------------------------------------- */
+
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include <linux/spi/spidev.h>
+
+#include "gnublin.h"
+
+/* -------------------------------------------------------------------------- */
+
+#define TRANSPORT_MAX_XFERS  16        /* Maximum number of accesses in a transfer. */
+#define TRANSPORT_MAX_LEN    64        /* Maximum number of bytes of an access (FIFO size). */
+
+#define SPI_DEFAULT_SPEED    4000000   /* 4 MHz, maximum SPI clock of the SC16IS740/750. */
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @class sc16is7x0_xfer
+ * @~english
+ * @brief A register access of a transfer.
+ */
+class sc16is7x0_xfer {
+
+ public :
+    unsigned char reg;     /* The register index (not encoded). */
+    int read;              /* 1 to read the register, 0 to write it. */
+    unsigned char *buffer;
+    unsigned int len;
+};
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @class sc16is7x0_transport
+ * @~english
+ * @brief Interface for accessing the registers of the chip.
+ */
+class sc16is7x0_transport {
+
+ protected :
+    bool errorFlag;
+    std::string errorMessage;
+    unsigned long transactions;
+
+    virtual int execute(sc16is7x0_xfer *xfers, int count) = 0;
+
+ public :
+    sc16is7x0_transport(void);
+    virtual ~sc16is7x0_transport(void);
+    const char* getErrorMessage(void);
+    bool fail(void);
+    int send(unsigned char reg, unsigned char *buffer, int len);
+    int receive(unsigned char reg, unsigned char *buffer, int len);
+    int transfer(sc16is7x0_xfer *xfers, int count);
+    virtual std::string getBus(void);
+    virtual int scan(sc16is7x0_transport **transports, int count, unsigned char reg, unsigned char *values);
+    unsigned long getTransactions(void);
+    void resetTransactions(void);
+};
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @class sc16is7x0_transport_i2c
+ * @~english
+ * @brief Access the registers via I2C (combined transactions with I2C_RDWR).
+ */
+class sc16is7x0_transport_i2c : public sc16is7x0_transport {
+
+ protected :
+    int fd;
+    int address;
+    std::string devicefile;
+
+    int execute(sc16is7x0_xfer *xfers, int count);
+
+ public :
+    sc16is7x0_transport_i2c(int address = 0x20, std::string filename = "/dev/i2c-1");
+    ~sc16is7x0_transport_i2c(void);
+    void setAddress(int address);
+    void setDevicefile(std::string filename);
+    std::string getBus(void);
+    int scan(sc16is7x0_transport **transports, int count, unsigned char reg, unsigned char *values);
+};
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @class sc16is7x0_transport_spi
+ * @~english
+ * @brief Access the registers via SPI using the spidev interface.
+ */
+class sc16is7x0_transport_spi : public sc16is7x0_transport {
+
+ protected :
+    int fd;
+    std::string devicefile;
+    unsigned int speed;
+
+    int execute(sc16is7x0_xfer *xfers, int count);
+
+ public :
+    sc16is7x0_transport_spi(std::string filename = "/dev/spidev0.0", unsigned int speed = SPI_DEFAULT_SPEED);
+    ~sc16is7x0_transport_spi(void);
+    void setDevicefile(std::string filename);
+    void setSpeed(unsigned int speed);
+};
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @class sc16is7x0_transport_mock
+ * @~english
+ * @brief Simulate the registers and the FIFO of a chip. The data written in
+ * the TX FIFO stays there until drained (transmitted), the data injected is
+ * put in the RX FIFO. In loopback mode (MCR[4]) the data written is received
+ * back. The software flow control (EFR[3:0]), the special character
+ * detection (EFR[5]), the multidrop mode (EFCR[1:0]), the automatic CTS
+ * flow control (EFR[7]), the modem status and the receiver line status
+ * errors are simulated.
+ */
+class sc16is7x0_transport_mock : public sc16is7x0_transport {
+
+ protected :
+    unsigned char regs[16];   /* General register set. */
+    unsigned char dll;
+    unsigned char dlh;
+    unsigned char efr;
+    unsigned char xon[2];
+    unsigned char xoff[2];
+    unsigned char tcr;
+    unsigned char tlr;
+    unsigned char fcr;
+    int thrArmed;             /* The THR interrupt is cleared by reading IIR. */
+    int txStopped;            /* XOFF received (software flow control). */
+    int xoffReceived;         /* The XOFF interrupt is cleared by reading IIR. */
+    int xoffSent;             /* XOFF sent to the peer (software flow control). */
+    int overrun;              /* Overrun error, cleared by reading LSR. */
+    unsigned char msr;        /* Modem status, the delta bits are cleared by reading MSR. */
+    int ctsInactive;          /* CTS went inactive, the interrupt is cleared by reading IIR. */
+
+    unsigned char rxFifo[TRANSPORT_MAX_LEN];
+    unsigned char rxErrors[TRANSPORT_MAX_LEN];  /* Error flags (LSR[4:2]) of the bytes received. */
+    unsigned int rxHead;
+    unsigned int rxCount;
+    unsigned char txFifo[TRANSPORT_MAX_LEN];
+    unsigned int txHead;
+    unsigned int txCount;
+
+    int execute(sc16is7x0_xfer *xfers, int count);
+    unsigned char readRegister(unsigned char reg);
+    void writeRegister(unsigned char reg, unsigned char value);
+    void lineTransmit(unsigned char value);
+    void lineReceive(unsigned char value, unsigned char errors = 0);
+    unsigned char interruptId(void);
+    unsigned int rxTrigger(void);
+    unsigned int txTrigger(void);
+
+ public :
+    sc16is7x0_transport_mock(void);
+    void reset(void);
+    int inject(const char *buffer, unsigned int len);
+    int injectError(const char *buffer, unsigned int len, unsigned char errors);
+    void injectAddress(unsigned char address);
+    void setCts(int active);
+    int drain(char *buffer, unsigned int len);
+    int rxLevel(void);
+    int txLevel(void);
+    int isIntPending(void);
+};
+
+/* -------------------------------------------------------------------------- */
+
+#endif
+
+/* module_sc16is7x0_transport.h ends here */
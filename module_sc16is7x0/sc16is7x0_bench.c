@@ -0,0 +1,360 @@
+/* sc16is7x0_bench.c --- 
+ * 
+ * Filename     : sc16is7x0_bench.c
+ * Description  : Loopback throughput benchmark of the SC16IS7x0 driver.
+ * Author       : Christophe Burki
+ * Maintainer   : Christophe Burki
+ * Created      : Sat Oct 17 17:05:41 2026
+ * Version      : 1.0.0
+ * Last-Updated : 
+ *           By : 
+ *     Update # : 0
+ * URL          : 
+ * Keywords     : 
+ * Compatibility: 
+ * 
+ */
+
+/* Commentary   : 
+ *
+ * The UART is put in internal loopback (MCR[4]) and blocks of data are
+ * written and read back for each combination of baud rate, FIFO enabled or
+ * not and RX trigger level. The RX FIFO is drained by polling the IIR
+ * (pollInt) so that the trigger levels have their effect.
+ *
+ *     make bench
+ *     sc16is7x0_bench -a 0x4d -n 8192
+ *     sc16is7x0_bench -m
+ *
+ * With -m the simulated chip (mock transport) is used. The line is then
+ * infinitely fast and the figures only reflect the cost of the driver hot
+ * path, they could be compared between builds to catch regressions.
+ *
+ * For each run, the throughput (bytes/s), the number of register
+ * transactions per byte, the CPU time and the round trip latency of the
+ * blocks (p50 and p99) are reported.
+ *
+ */
+
+/* Change log:
+ * 
+ * 
+ */
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as 
+ * published by the Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file LICENSE.  If not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth
+ * ;; Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* Code         : */
+
+/* -------------------------------------------------------------------------- */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "gnublin.h"
+#include "module_sc16is740.h"
+#include "module_sc16is750.h"
+
+/* -------------------------------------------------------------------------- */
+
+#define BENCH_DEFAULT_BYTES 4096  /* Bytes sent per run. */
+#define BENCH_DEFAULT_BLOCK 32    /* Bytes written at once. */
+#define BENCH_BLOCK_TIMEOUT 1000  /* Time in ms for a block to come back. */
+
+/* -------------------------------------------------------------------------- */
+
+static const unsigned int bauds[] = {UART_115200, UART_460800, UART_921600};
+static const unsigned int levels[] = {8, 16, 56};
+
+#define BAUDS_COUNT (int)(sizeof(bauds) / sizeof(bauds[0]))
+#define LEVELS_COUNT (int)(sizeof(levels) / sizeof(levels[0]))
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @~english
+ * @brief Return the time of the given clock in microseconds.
+ */
+static long long now(clockid_t clock) {
+
+    struct timespec ts;
+
+    clock_gettime(clock, &ts);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @class bench_run
+ * @~english
+ * @brief A run of the benchmark : the configuration and the results.
+ */
+class bench_run {
+
+ public :
+    unsigned int baud;
+    int fifo;
+    unsigned int level;
+    unsigned int block;
+    int simulated;            /* The line rate is not simulated, the baud rate and trigger level are not relevant. */
+
+    unsigned long received;   /* Bytes received in the current block. */
+    unsigned long errors;     /* Bytes received different from the ones sent. */
+    const char *expected;     /* Data expected in the current block. */
+    sc16is7x0_histogram latency;
+};
+
+
+/**
+ * @~english
+ * @brief Data received ISR, check the data against the block sent.
+ */
+static void onData(const char *buffer, int len, void *context) {
+
+    bench_run *run = (bench_run *)context;
+
+    for (int i = 0; i < len; i++) {
+        if ((run->received + i >= run->block) || (buffer[i] != run->expected[run->received + i])) {
+            run->errors++;
+        }
+    }
+    run->received += len;
+}
+
+
+/**
+ * @~english
+ * @brief Configure the UART for the run.
+ *
+ * @return -1 on error and 1 on success.
+ */
+static int setup(gnublin_module_sc16is7x0 *uart, bench_run *run, unsigned long xtal) {
+
+    uart->init();
+    uart->setCrystalFrequency(xtal);
+    if (uart->setBaudRate(run->baud) < 0) {
+        return -1;
+    }
+    uart->enableFifo(run->fifo);
+    if (run->fifo) {
+        uart->rxFifoSetTriggerLevel(run->level);
+    }
+    uart->enableLoopback();
+    uart->setInterrupt(CONF_INT_RHREN);
+    uart->intIsrDataReceived(&onData, run);
+
+    return uart->fail() ? -1 : 1;
+}
+
+
+/**
+ * @~english
+ * @brief Do a run : write the blocks and poll the interrupts until each
+ * block is received back.
+ *
+ * @return -1 on error and 1 on success.
+ */
+static int bench(gnublin_module_sc16is7x0 *uart, bench_run *run, unsigned long bytes) {
+
+    sc16is7x0_transport *transport = uart->getTransport();
+    char data[FIFO_SIZE];
+    unsigned long sent = 0;
+
+    for (unsigned int i = 0; i < sizeof(data); i++) {
+        data[i] = (char)(i * 7 + 1);
+    }
+    run->expected = data;
+    run->errors = 0;
+    run->latency.reset();
+
+    transport->resetTransactions();
+    long long cpuStart = now(CLOCK_PROCESS_CPUTIME_ID);
+    long long start = now(CLOCK_MONOTONIC);
+
+    while (sent < bytes) {
+        long long blockStart = now(CLOCK_MONOTONIC);
+
+        run->received = 0;
+        if (uart->write(data, run->block) < 0) {
+            return -1;
+        }
+
+        while (run->received < run->block) {
+            if (uart->pollInt() < 0) {
+                return -1;
+            }
+            if (now(CLOCK_MONOTONIC) - blockStart > BENCH_BLOCK_TIMEOUT * 1000LL) {
+                printf("ERROR : block of %u bytes not received (%lu received)\n", run->block, run->received);
+                return -1;
+            }
+        }
+
+        run->latency.record(now(CLOCK_MONOTONIC) - blockStart);
+        sent += run->block;
+    }
+
+    long long elapsed = now(CLOCK_MONOTONIC) - start;
+    long long cpu = now(CLOCK_PROCESS_CPUTIME_ID) - cpuStart;
+
+    if (run->simulated) {
+        printf("%7s  %4s  %7s", "-", run->fifo ? "on" : "off", "-");
+    }
+    else {
+        printf("%7u  %4s  %7u", run->baud, run->fifo ? "on" : "off", run->fifo ? run->level : 1);
+    }
+    printf("  %10.0f  %10.3f  %8.1f  %8lu  %8lu  %6lu\n",
+           sent * 1000000.0 / elapsed,
+           (double)transport->getTransactions() / sent,
+           cpu / 1000.0,
+           run->latency.getPercentile(50), run->latency.getPercentile(99),
+           run->errors);
+
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Print the usage.
+ */
+static void usage(const char *name) {
+
+    printf("Usage : %s [-m] [-c 740|750] [-a address] [-d i2c device] [-s spi device] [-x crystal] [-b baud] [-n bytes] [-k block]\n", name);
+}
+
+/* -------------------------------------------------------------------------- */
+
+int main(int argc, char **argv) {
+
+    int chip = 750;
+    int address = 0x4d;
+    std::string device = "/dev/i2c-1";
+    const char *spiDevice = NULL;
+    unsigned long xtal = XTAL_FREQ;
+    unsigned int baud = 0;
+    unsigned long bytes = BENCH_DEFAULT_BYTES;
+    unsigned int block = BENCH_DEFAULT_BLOCK;
+    int mock = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "mc:a:d:s:x:b:n:k:h")) != -1) {
+        switch (opt) {
+        case 'm' :
+            mock = 1;
+            break;
+        case 'c' :
+            chip = atoi(optarg);
+            break;
+        case 'a' :
+            address = strtol(optarg, NULL, 0);
+            break;
+        case 'd' :
+            device = optarg;
+            break;
+        case 's' :
+            spiDevice = optarg;
+            break;
+        case 'x' :
+            xtal = strtoul(optarg, NULL, 0);
+            break;
+        case 'b' :
+            baud = strtoul(optarg, NULL, 0);
+            break;
+        case 'n' :
+            bytes = strtoul(optarg, NULL, 0);
+            break;
+        case 'k' :
+            block = strtoul(optarg, NULL, 0);
+            break;
+        default :
+            usage(argv[0]);
+            return -1;
+        }
+    }
+
+    if ((block == 0) || (block > FIFO_SIZE)) {
+        printf("ERROR : the block size must be between 1 and %d\n", FIFO_SIZE);
+        return -1;
+    }
+
+    /* UART */
+    gnublin_module_sc16is7x0 *uart;
+    if (chip == 740) {
+        uart = new gnublin_module_sc16is740(address, device);
+    }
+    else {
+        uart = new gnublin_module_sc16is750(address, device);
+    }
+
+    sc16is7x0_transport_spi spi(spiDevice != NULL ? spiDevice : "/dev/spidev0.0");
+    sc16is7x0_transport_mock simulated;
+    if (mock) {
+        uart->setTransport(&simulated);
+    }
+    else if (spiDevice != NULL) {
+        uart->setTransport(&spi);
+    }
+
+    printf("%s, %lu bytes per run, blocks of %u bytes\n", mock ? "simulated chip" : (spiDevice != NULL ? spiDevice : device.c_str()), bytes, block);
+    if (mock) {
+        /* The simulated chip moves the data at once, the runs would only
+           differ by their labels. */
+        printf("the line rate is not simulated, the baud rate and trigger level are not varied\n");
+    }
+    printf("   baud  fifo  trigger     bytes/s  trans/byte   cpu(ms)  p50(us)  p99(us)  errors\n");
+
+    bench_run run;
+    run.simulated = mock;
+    for (int i = 0; i < (mock ? 1 : BAUDS_COUNT); i++) {
+        if (!mock && (baud != 0) && (bauds[i] != baud)) {
+            continue;
+        }
+
+        for (int fifo = 0; fifo <= 1; fifo++) {
+            for (int j = 0; j < ((fifo && !mock) ? LEVELS_COUNT : 1); j++) {
+                run.baud = bauds[i];
+                run.fifo = fifo;
+                run.level = levels[j];
+
+                /* Without FIFO the bytes are received one by one, a larger
+                   block overruns the receiver. */
+                run.block = fifo ? block : 1;
+
+                if (setup(uart, &run, xtal) < 0) {
+                    printf("%7u  %4s  %7u  skipped : %s", run.baud, fifo ? "on" : "off", fifo ? run.level : 1, uart->getErrorMessage());
+                    continue;
+                }
+
+                if (bench(uart, &run, bytes) < 0) {
+                    if (uart->fail()) {
+                        printf("ERROR : %s", uart->getErrorMessage());
+                    }
+                    delete uart;
+                    return -1;
+                }
+            }
+        }
+    }
+
+    uart->init();
+    delete uart;
+
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* sc16is7x0_bench.c ends here */
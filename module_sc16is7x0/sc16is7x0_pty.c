@@ -0,0 +1,666 @@
+/* sc16is7x0_pty.c --- 
+ * 
+ * Filename     : sc16is7x0_pty.c
+ * Description  : Daemon exposing a SC16IS7x0 UART as a pseudo-terminal.
+ * Author       : Christophe Burki
+ * Maintainer   : Christophe Burki
+ * Created      : Sat Oct 17 15:32:04 2026
+ * Version      : 1.0.0
+ * Last-Updated : 
+ *           By : 
+ *     Update # : 0
+ * URL          : 
+ * Keywords     : 
+ * Compatibility: 
+ * 
+ */
+
+/* Commentary   : 
+ *
+ * The UART is exposed as a pseudo-terminal so that minicom, pyserial or any
+ * serial stack could use it without linking the gnublin modules.
+ *
+ *     sc16is7x0_pty -a 0x4d -i 22 -l /dev/ttySC0 -r 10
+ *
+ * The IRQ line of the chip and the master side of the pseudo-terminal are
+ * waited for by a reactor. The RX FIFO is drained in bursts on RHR
+ * interrupts and written to the pseudo-terminal. The data written to the
+ * pseudo-terminal is copied in the TX ring buffer and sent in FIFO sized
+ * bursts on THR interrupts. The reading of the pseudo-terminal is paused
+ * while the TX ring buffer is full.
+ *
+ * The termios settings of the pseudo-terminal (speed, size, parity, stop
+ * bits, RTS/CTS and XON/XOFF) are applied to the UART when they change.
+ *
+ * Statistics (throughput and latency) are printed for each direction every
+ * report interval and when the daemon exits. The RX latency is the time
+ * from the servicing of the IRQ to the data written to the
+ * pseudo-terminal. The TX latency is the time from the data read from the
+ * pseudo-terminal to the TX ring buffer empty.
+ *
+ */
+
+/* Change log:
+ * 
+ * 
+ */
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as 
+ * published by the Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file LICENSE.  If not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth
+ * ;; Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* Code         : */
+
+/* -------------------------------------------------------------------------- */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+
+#include "gnublin.h"
+#include "module_sc16is740.h"
+#include "module_sc16is750.h"
+
+/* -------------------------------------------------------------------------- */
+
+#define PTY_TERMIOS_PERIOD 200  /* Period in ms at which the termios settings are checked. */
+#define PTY_READ_SIZE      256  /* Maximum number of bytes read from the pseudo-terminal at once. */
+
+/* -------------------------------------------------------------------------- */
+
+/* Speeds supported by termios. */
+static const struct {
+    speed_t speed;
+    unsigned int baud;
+} speeds[] = {
+    {B300, UART_300}, {B600, UART_600}, {B1200, UART_1200}, {B2400, UART_2400},
+    {B4800, UART_4800}, {B9600, UART_9600}, {B19200, UART_19200}, {B38400, UART_38400},
+    {B57600, UART_57600}, {B115200, UART_115200}, {B230400, UART_230400},
+    {B460800, UART_460800}, {B921600, UART_921600}
+};
+
+#define SPEEDS_COUNT (int)(sizeof(speeds) / sizeof(speeds[0]))
+
+static volatile sig_atomic_t stopped = 0;
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @~english
+ * @brief Return the current time in microseconds.
+ */
+static long long now(void) {
+
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+
+/**
+ * @~english
+ * @brief Stop the daemon on SIGINT and SIGTERM.
+ */
+static void onSignal(int sig) {
+
+    stopped = 1;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @class pty_stats
+ * @~english
+ * @brief Throughput and latency of one direction of the bridge.
+ */
+class pty_stats {
+
+ public :
+    const char *name;
+    unsigned long long bytes;      /* Bytes since the last report. */
+    unsigned long long total;      /* Bytes since the start. */
+    unsigned long bursts;
+    unsigned long dropped;         /* Bytes dropped. */
+    long long latencyMin;          /* Latencies in us since the last report. */
+    long long latencyMax;
+    long long latencySum;
+    unsigned long latencyCount;
+    long long start;               /* Start of the report interval. */
+
+    pty_stats(const char *name) : name(name), total(0), dropped(0) { reset(); }
+
+    void reset(void) {
+        bytes = 0;
+        bursts = 0;
+        latencyMin = 0;
+        latencyMax = 0;
+        latencySum = 0;
+        latencyCount = 0;
+        start = now();
+    }
+
+    void add(unsigned int len) {
+        bytes += len;
+        total += len;
+    }
+
+    void sample(long long latency) {
+        bursts++;
+        if ((latencyCount == 0) || (latency < latencyMin)) {
+            latencyMin = latency;
+        }
+        if (latency > latencyMax) {
+            latencyMax = latency;
+        }
+        latencySum += latency;
+        latencyCount++;
+    }
+
+    void report(void) {
+        double elapsed = (now() - start) / 1000000.0;
+        printf("%s : %.0f B/s, %lu bursts, %llu bytes total, %lu dropped", name, elapsed > 0 ? bytes / elapsed : 0.0, bursts, total, dropped);
+        if (latencyCount > 0) {
+            printf(", latency min/avg/max %lld/%lld/%lld us", latencyMin, latencySum / (long long)latencyCount, latencyMax);
+        }
+        printf("\n");
+        reset();
+    }
+};
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @class pty_source
+ * @~english
+ * @brief The master side of the pseudo-terminal as a reactor source.
+ */
+class pty_source : public gnublin_irq_source {
+
+ public :
+    pty_source(int master) { fd = master; }
+    short getEvents(void) { return POLLIN; }
+    int ack(void) { return 1; }
+};
+
+/* -------------------------------------------------------------------------- */
+
+class pty_bridge;
+
+/**
+ * @class pty_handler
+ * @~english
+ * @brief Call the bridge when data is written to the pseudo-terminal.
+ */
+class pty_handler : public gnublin_irq_handler {
+
+ public :
+    pty_bridge *bridge;
+    int pollInt(void);
+};
+
+
+/**
+ * @class uart_handler
+ * @~english
+ * @brief Call the bridge on the UART interrupts.
+ */
+class uart_handler : public gnublin_irq_handler {
+
+ public :
+    pty_bridge *bridge;
+    int pollInt(void);
+};
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @class pty_bridge
+ * @~english
+ * @brief Shuttle the data between the UART and the pseudo-terminal.
+ */
+class pty_bridge {
+
+ public :
+    gnublin_module_sc16is7x0 *uart;
+    gnublin_irq_reactor *reactor;
+    int master;
+    int slave;
+    pty_source source;
+    pty_handler ptyHandler;
+    uart_handler uartHandler;
+    bool paused;                /* Reading of the pseudo-terminal paused. */
+    long long serviceStart;     /* Start of the UART servicing. */
+    long long txStart;          /* Data read from the pseudo-terminal while the TX ring was empty. */
+    struct termios settings;    /* Termios settings applied to the UART. */
+    pty_stats rxStats;
+    pty_stats txStats;
+
+    pty_bridge(gnublin_module_sc16is7x0 *uart, gnublin_irq_reactor *reactor, int master, int slave);
+    static void dataReceived(const char *buffer, int len, void *context);
+    int ptyRead(void);
+    int uartService(void);
+    void txDone(void);
+    int applyTermios(void);
+};
+
+
+/**
+ * @~english
+ * @brief Create the bridge. The UART data received ISR writes to the
+ * pseudo-terminal.
+ */
+pty_bridge::pty_bridge(gnublin_module_sc16is7x0 *uart, gnublin_irq_reactor *reactor, int master, int slave)
+    : source(master), rxStats("uart->pty"), txStats("pty->uart") {
+
+    this->uart = uart;
+    this->reactor = reactor;
+    this->master = master;
+    this->slave = slave;
+    paused = false;
+    serviceStart = 0;
+    txStart = 0;
+    memset(&settings, 0, sizeof(settings));
+
+    ptyHandler.bridge = this;
+    uartHandler.bridge = this;
+    uart->intIsrDataReceived(&dataReceived, this);
+}
+
+
+/**
+ * @~english
+ * @brief Write the data received by the UART to the pseudo-terminal. The
+ * data is dropped when the pseudo-terminal is full (nobody reading).
+ */
+void pty_bridge::dataReceived(const char *buffer, int len, void *context) {
+
+    pty_bridge *bridge = (pty_bridge *)context;
+    int written = 0;
+
+    while (written < len) {
+        int ret = write(bridge->master, buffer + written, len - written);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            bridge->rxStats.dropped += len - written;
+            break;
+        }
+        written += ret;
+    }
+
+    bridge->rxStats.add(written);
+    bridge->rxStats.sample(now() - bridge->serviceStart);
+}
+
+
+/**
+ * @~english
+ * @brief Copy the data written to the pseudo-terminal in the TX ring buffer.
+ * At most the free space of the ring is read. The reading is paused when
+ * the ring is full, it is resumed by the UART servicing.
+ *
+ * @return -1 on error, 0 when no more data is available and 1 otherwise.
+ */
+int pty_bridge::ptyRead(void) {
+
+    char buffer[PTY_READ_SIZE];
+    int room = TX_BUFFER_SIZE - uart->txBufferedData();
+    int len;
+
+    if (room == 0) {
+        if (reactor->remove(&ptyHandler) < 0) {
+            return -1;
+        }
+        paused = true;
+        return 0;
+    }
+
+    if (room > PTY_READ_SIZE) {
+        room = PTY_READ_SIZE;
+    }
+
+    if ((len = read(master, buffer, room)) < 0) {
+        if ((errno == EAGAIN) || (errno == EINTR)) {
+            return 0;
+        }
+        printf("ERROR : read (pty) : %s\n", strerror(errno));
+        return -1;
+    }
+
+    if (len == 0) {
+        return 0;
+    }
+
+    if (uart->txBufferedData() == 0) {
+        txStart = now();
+    }
+
+    if (uart->write(buffer, len) < 0) {
+        printf("ERROR : %s", uart->getErrorMessage());
+        return -1;
+    }
+
+    txStats.add(len);
+    txDone();
+
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Service the UART interrupts and resume the reading of the
+ * pseudo-terminal when the TX ring buffer has room for a FIFO.
+ *
+ * @return -1 on error and the number of interrupts serviced on success.
+ */
+int pty_bridge::uartService(void) {
+
+    int ret;
+
+    serviceStart = now();
+    if ((ret = uart->pollInt()) < 0) {
+        printf("ERROR : %s", uart->getErrorMessage());
+        return -1;
+    }
+
+    txDone();
+
+    if (paused && (TX_BUFFER_SIZE - uart->txBufferedData() >= FIFO_SIZE)) {
+        paused = false;
+        if (reactor->add(&ptyHandler, &source) < 0) {
+            return -1;
+        }
+    }
+
+    return ret;
+}
+
+
+/**
+ * @~english
+ * @brief Account the TX latency when the TX ring buffer is empty.
+ */
+void pty_bridge::txDone(void) {
+
+    if ((txStart != 0) && (uart->txBufferedData() == 0)) {
+        txStats.sample(now() - txStart);
+        txStart = 0;
+    }
+}
+
+
+/**
+ * @~english
+ * @brief Apply the termios settings of the pseudo-terminal to the UART when
+ * they change.
+ *
+ * @return -1 on error, 0 when nothing changed and 1 otherwise.
+ */
+int pty_bridge::applyTermios(void) {
+
+    struct termios tio;
+    unsigned char format;
+    unsigned char flow = CONF_FLOW_NONE;
+    speed_t speed;
+
+    if (tcgetattr(slave, &tio) < 0) {
+        printf("ERROR : tcgetattr : %s\n", strerror(errno));
+        return -1;
+    }
+
+    if ((tio.c_cflag == settings.c_cflag) && ((tio.c_iflag & (IXON | IXOFF)) == (settings.c_iflag & (IXON | IXOFF))) &&
+        (cfgetospeed(&tio) == cfgetospeed(&settings))) {
+        return 0;
+    }
+
+    /* Speed */
+    speed = cfgetospeed(&tio);
+    if (speed != cfgetospeed(&settings)) {
+        int i;
+        for (i = 0; i < SPEEDS_COUNT; i++) {
+            if (speeds[i].speed == speed) {
+                break;
+            }
+        }
+
+        if (i == SPEEDS_COUNT) {
+            printf("WARNING : speed not supported\n");
+        }
+        else if (uart->setBaudRate(speeds[i].baud) < 0) {
+            printf("WARNING : %s", uart->getErrorMessage());
+        }
+        else {
+            printf("baud rate=%u, error=%.2f%%\n", uart->getBaudRate(), uart->getBaudRateError());
+        }
+    }
+
+    /* Data format : LCR[1:0] word length, LCR[2] stop bits, LCR[3] parity
+       enable, LCR[4] even parity. */
+    switch (tio.c_cflag & CSIZE) {
+    case CS5 :
+        format = 0x00;
+        break;
+    case CS6 :
+        format = 0x01;
+        break;
+    case CS7 :
+        format = 0x02;
+        break;
+    default :
+        format = 0x03;
+        break;
+    }
+    if (tio.c_cflag & CSTOPB) {
+        format |= 0x04;
+    }
+    if (tio.c_cflag & PARENB) {
+        format |= (tio.c_cflag & PARODD) ? 0x08 : 0x18;
+    }
+    if (uart->setDataFormat(format) < 0) {
+        printf("WARNING : %s", uart->getErrorMessage());
+    }
+
+    /* Flow control */
+    if (tio.c_cflag & CRTSCTS) {
+        flow |= CONF_FLOW_CTS | CONF_FLOW_RTS;
+    }
+    if (tio.c_iflag & IXON) {
+        flow |= CONF_FLOW_RX_XON1;
+    }
+    if (tio.c_iflag & IXOFF) {
+        flow |= CONF_FLOW_TX_XON1;
+    }
+    if (uart->setFlowControl(flow) < 0) {
+        printf("WARNING : %s", uart->getErrorMessage());
+    }
+
+    settings = tio;
+    return 1;
+}
+
+
+int pty_handler::pollInt(void) {
+
+    return bridge->ptyRead();
+}
+
+
+int uart_handler::pollInt(void) {
+
+    return bridge->uartService();
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void usage(const char *name) {
+
+    printf("Usage : %s [-c 740|750] [-a address] [-d i2c device] [-s spi device] [-x crystal] [-i irq pin] [-l link] [-r report interval]\n", name);
+}
+
+/* -------------------------------------------------------------------------- */
+
+int main(int argc, char **argv) {
+
+    int chip = 750;
+    int address = 0x4d;
+    std::string device = "/dev/i2c-1";
+    const char *spiDevice = NULL;
+    unsigned long xtal = XTAL_FREQ;
+    int pin = 22;
+    const char *link = NULL;
+    int interval = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:a:d:s:x:i:l:r:h")) != -1) {
+        switch (opt) {
+        case 'c' :
+            chip = atoi(optarg);
+            break;
+        case 'a' :
+            address = strtol(optarg, NULL, 0);
+            break;
+        case 'd' :
+            device = optarg;
+            break;
+        case 's' :
+            spiDevice = optarg;
+            break;
+        case 'x' :
+            xtal = strtoul(optarg, NULL, 0);
+            break;
+        case 'i' :
+            pin = atoi(optarg);
+            break;
+        case 'l' :
+            link = optarg;
+            break;
+        case 'r' :
+            interval = atoi(optarg);
+            break;
+        default :
+            usage(argv[0]);
+            return -1;
+        }
+    }
+
+    /* UART */
+    gnublin_module_sc16is7x0 *uart;
+    if (chip == 740) {
+        uart = new gnublin_module_sc16is740(address, device);
+    }
+    else {
+        uart = new gnublin_module_sc16is750(address, device);
+    }
+
+    sc16is7x0_transport_spi spi(spiDevice != NULL ? spiDevice : "/dev/spidev0.0");
+    if (spiDevice != NULL) {
+        uart->setTransport(&spi);
+    }
+
+    uart->setCrystalFrequency(xtal);
+    uart->init();
+    uart->enableFifo(1);
+    uart->enableTxBuffer(1);
+    uart->setInterrupt(CONF_INT_RHREN);
+    if (uart->fail()) {
+        printf("ERROR : %s", uart->getErrorMessage());
+        return -1;
+    }
+
+    /* Pseudo-terminal */
+    int master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if ((master < 0) || (grantpt(master) < 0) || (unlockpt(master) < 0)) {
+        printf("ERROR : posix_openpt : %s\n", strerror(errno));
+        return -1;
+    }
+
+    /* The slave is kept opened so that the master does not hang up when the
+       clients close it and to get its termios settings. */
+    const char *name = ptsname(master);
+    int slave = open(name, O_RDWR | O_NOCTTY);
+    if (slave < 0) {
+        printf("ERROR : open (%s) : %s\n", name, strerror(errno));
+        return -1;
+    }
+
+    struct termios tio;
+    tcgetattr(slave, &tio);
+    cfmakeraw(&tio);
+    cfsetspeed(&tio, B9600);
+    tcsetattr(slave, TCSANOW, &tio);
+
+    if ((link != NULL) && (symlink(name, link) < 0)) {
+        printf("ERROR : symlink (%s) : %s\n", link, strerror(errno));
+        return -1;
+    }
+    printf("%s\n", link != NULL ? link : name);
+
+    /* Bridge */
+    gnublin_irq_sysfs irq(pin, IRQ_EDGE_FALLING);
+    if (irq.fail()) {
+        printf("ERROR : %s", irq.getErrorMessage());
+        return -1;
+    }
+
+    gnublin_irq_reactor reactor;
+    pty_bridge bridge(uart, &reactor, master, slave);
+    bridge.applyTermios();
+
+    if ((reactor.add(&bridge.uartHandler, &irq) < 0) || (reactor.add(&bridge.ptyHandler, &bridge.source) < 0)) {
+        printf("ERROR : %s", reactor.getErrorMessage());
+        return -1;
+    }
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    long long report = now();
+    while (!stopped) {
+        if (reactor.wait(PTY_TERMIOS_PERIOD) < 0) {
+            printf("ERROR : %s", reactor.getErrorMessage());
+            break;
+        }
+
+        if (bridge.applyTermios() < 0) {
+            break;
+        }
+
+        if ((interval > 0) && (now() - report >= interval * 1000000LL)) {
+            bridge.rxStats.report();
+            bridge.txStats.report();
+            report = now();
+        }
+    }
+
+    bridge.rxStats.report();
+    bridge.txStats.report();
+
+    if (link != NULL) {
+        unlink(link);
+    }
+    close(slave);
+    delete uart;
+
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* sc16is7x0_pty.c ends here */
@@ -46,21 +46,18 @@
 /* -------------------------------------------------------------------------- */
 
 #include <stdio.h>
-#include <poll.h>
 
 #include "gnublin.h"
 #include "module_sc16is750.h"
 
 /* -------------------------------------------------------------------------- */
 
-#define POLL_TIMEOUT (1 * 1000)  /* 1 second */
+void onDataReceived(const char *buffer, int len, void *context) {
+    printf("onDataReceived(buffer=%.*s, len=%d)\n", len, buffer, len);
 
-/* -------------------------------------------------------------------------- */
-
-void onDataReceived(char *buffer, int len) {
-    printf("onDataReceived(buffer=%s, len=%d)\n", buffer, len);
-
-    free(buffer);
+    if ((context != NULL) && (memchr(buffer, 'q', len) != NULL)) {
+        ((gnublin_irq_reactor *)context)->stop();
+    }
 }
 
 
@@ -95,33 +92,6 @@ int main(void) {
     bytes = sc16is750.write("0123456789012345678901234567890123456789012345678901234567890123567890123456789\n", 81);
     printf("bytes=%d\n", bytes);
 
-    int available = 0;
-    char buffer[2048];
-    int i = 0;
-    while (1) {
-
-        if ((available = sc16is750.rxAvailableData()) > 0) {
-
-            char rcvBuf[available + 1];
-            sc16is750.read(rcvBuf, available);
-            if (rcvBuf[available - 1] == 0x0d) {
-                buffer[i] = '\0';
-                i = 0;
-            }
-            else {
-                rcvBuf[available] = '\0';
-                buffer[i] = *rcvBuf;
-                i += available;
-            }
-
-            printf("buffer=%s\n", buffer);
-
-            if (strcmp(buffer, "exit") == 0) {
-                break;
-            }
-        }
-    }
-
     /*
      * Testing UART interrupts
      *
@@ -129,45 +99,36 @@ int main(void) {
      * #22     IRQ
      * #18     GPIO0
      *
-     * Press 'q' to exit.
+     * Send lines terminated by LF, "exit" to continue and then 'q' to exit.
      */
 
     gpio.pinMode(18, OUTPUT);
-    gpio.pinMode(22, INPUT);
-
-    int nfds = 2;
-    struct pollfd fdset[nfds];
-    int gpio22Fd;
-    int gpio22EdgeFd;
-    int timeout = POLL_TIMEOUT;
-    int nfd;
-
-    gpio22EdgeFd = open("/sys/class/gpio/gpio22/edge", O_WRONLY);
-    if (gpio22EdgeFd < 0) {
-        printf("gpio22EdgeFd Error");
-        return -1;
-    }
-    write(gpio22EdgeFd, "falling", 7);
-    close(gpio22EdgeFd);
 
-    gpio22Fd = open("/sys/class/gpio/gpio22/value", O_RDONLY | O_NONBLOCK);
-    if (gpio22Fd < 0) {
-        printf("gpio22Fd/open Error");
+    gnublin_irq_sysfs irq(22, IRQ_EDGE_FALLING);
+    gnublin_irq_reactor reactor;
+    if (irq.fail()) {
+        printf("ERROR : %s\n", irq.getErrorMessage());
         return -1;
     }
 
-    /* */
-    read(gpio22Fd, NULL, 1);
+    /* Wait on the IRQ for lines. */
+    const char *line;
+    sc16is750.setIrqSource(&irq);
+    sc16is750.setInterrupt(CONF_INT_RHREN);
+    while (1) {
+        if (sc16is750.readLine(&line, -1) < 0) {
+            printf("ERROR : %s\n", sc16is750.getErrorMessage());
+            break;
+        }
 
-    /* Initialize the pollfd structure. */
-    memset((void *)fdset, 0, sizeof(fdset));
-    fdset[0].fd = STDIN_FILENO;
-    fdset[0].events = POLLIN;
-    fdset[1].fd = gpio22Fd;
-    fdset[1].events = POLLPRI;
+        printf("line=%s\n", line);
 
+        if (strcmp(line, "exit") == 0) {
+            break;
+        }
+    }
 
-    sc16is750.intIsrDataReceived(&onDataReceived);
+    sc16is750.intIsrDataReceived(&onDataReceived, &reactor);
     sc16is750.intIsrSpaceAvailable(&onSpaceAvailable);
     
     sc16is750.init();
@@ -184,34 +145,11 @@ int main(void) {
     unsigned char status = sc16is750.readLineStatus();
     printf("status=0x%02x\n", status);
 
-    while (1) {
-        nfd = poll(fdset, nfds, timeout);
-        if (nfd < 0) {
-            printf("poll() failed\n");
-            return -1;
-        }
-
-        if (nfd == 0) {
-            /* Poll timeout. */
-        }
-
-        if (fdset[0].revents & POLLIN) {
-            char *c = (char *)malloc(sizeof(char));
-            read(fdset[0].fd, c, 1);
-
-            if (*c == 'q') {
-                break;
-            }
-        }
-
-        if (fdset[1].revents && POLLPRI) {
-            read(fdset[1].fd, NULL, 1);
-            int intCount = sc16is750.pollInt();
-            printf("intCount=%d\n", intCount);
-        }
+    reactor.add(&sc16is750, &irq);
+    if (reactor.run() < 0) {
+        printf("ERROR : %s\n", reactor.getErrorMessage());
+        return -1;
     }
-
-    close(gpio22Fd);
 }
 
 /* -------------------------------------------------------------------------- */
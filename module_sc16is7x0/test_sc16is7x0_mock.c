@@ -0,0 +1,610 @@
+/* test_sc16is7x0_mock.c --- 
+ * 
+ * Filename     : test_sc16is7x0_mock.c
+ * Description  : Test the sc16is7x0 module with the mock transport (no hardware).
+ * Author       : Christophe Burki
+ * Maintainer   : Christophe Burki
+ * Created      : Sat Oct 17 11:48:20 2026
+ * Version      : 1.0.0
+ * Last-Updated : 
+ *           By : 
+ *     Update # : 0
+ * URL          : 
+ * Keywords     : 
+ * Compatibility: 
+ * 
+ */
+
+/* Commentary   : 
+ * 
+ * 
+ * 
+ */
+
+/* Change log:
+ * 
+ * 
+ */
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as 
+ * published by the Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file LICENSE.  If not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth
+ * ;; Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* Code         : */
+
+
+/* -------------------------------------------------------------------------- */
+
+#include <stdio.h>
+#include <time.h>
+
+#include "gnublin.h"
+#include "module_sc16is750.h"
+#include "module_sc16is7x0_scheduler.h"
+
+/* -------------------------------------------------------------------------- */
+
+int failures = 0;
+
+void check(const char *name, int condition) {
+
+    printf("%s : %s\n", condition ? "PASS" : "FAIL", name);
+    if (!condition) {
+        failures++;
+    }
+}
+
+
+int received = 0;
+
+void onDataReceived(const char *buffer, int len, void *context) {
+    printf("onDataReceived(buffer=%.*s, len=%d)\n", len, buffer, len);
+    received += len;
+}
+
+
+int timestamped = 0;
+
+void onDataTimestamp(const char *buffer, int len, const sc16is7x0_timestamp *timestamp, void *context) {
+    long latency = (timestamp->drain.tv_sec - timestamp->edge.tv_sec) * 1000000 + (timestamp->drain.tv_nsec - timestamp->edge.tv_nsec) / 1000;
+    printf("onDataTimestamp(buffer=%.*s, len=%d, latency=%ldus)\n", len, buffer, len, latency);
+    timestamped += len;
+}
+
+
+int modemCount = 0;
+
+void onModem(unsigned char msr, void *context) {
+    printf("onModem(msr=0x%02x)\n", msr);
+    modemCount++;
+}
+
+
+int xoffCount = 0;
+
+void onXoff(void *context) {
+    printf("onXoff()\n");
+    xoffCount++;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int main(void) {
+    printf("Testing the sc16is750 module with the mock transport.\n");
+
+    sc16is7x0_transport_mock mock;
+    gnublin_module_sc16is750 sc16is750;
+    char buffer[128];
+    int len;
+
+    sc16is750.setTransport(&mock);
+    sc16is750.init();
+    check("init", !sc16is750.fail());
+    printf("init transactions=%lu\n", mock.getTransactions());
+
+    sc16is750.setBaudRate(UART_921600);
+    check("baud rate 921600", !sc16is750.fail() && (sc16is750.getBaudRate() == UART_921600));
+    sc16is750.setCrystalFrequency(48000000);
+    check("baud rate 460800 rejected", sc16is750.setBaudRate(UART_460800) < 0);
+    sc16is750.setBaudRate(UART_115200);
+    printf("baud rate=%u, error=%.2f%%\n", sc16is750.getBaudRate(), sc16is750.getBaudRateError());
+    sc16is750.setCrystalFrequency(XTAL_FREQ);
+    sc16is750.setBaudRate(UART_115200);
+    sc16is750.enableFifo(1);
+    check("configuration", !sc16is750.fail());
+
+    /* Configuration in one shot. */
+    sc16is7x0_uart_config uartConfig;
+    uartConfig.baudRate = UART_115200;
+    uartConfig.fifoEnable = 1;
+    uartConfig.rxTriggerLevel = 16;
+    uartConfig.txTriggerLevel = 32;
+    uartConfig.interrupt = CONF_INT_RHREN;
+    sc16is750.softReset();
+    mock.resetTransactions();
+    check("configure", sc16is750.configure(&uartConfig) == 1);
+    sc16is750.syncConfig();
+    check("configure baud rate", sc16is750.getBaudRate() == UART_115200);
+    mock.inject("0123456789abcdef", 16);
+    check("configure rx trigger", sc16is750.whichInt() == INT_RHR);
+
+    /* The cached FIFO levels are reset with the chip. */
+    sc16is750.init();
+    sc16is750.enableFifo(1);
+    mock.inject("01234567890123456789", 20);
+    sc16is750.read(buffer, 4);
+    sc16is750.softReset();
+    sc16is750.enableFifo(1);
+    check("soft reset rx level", (mock.rxLevel() == 0) && (sc16is750.read(buffer, sizeof(buffer)) == 0));
+    sc16is750.rxEmptyFifo();
+
+    /* Write and transmit. */
+    mock.resetTransactions();
+    len = sc16is750.write("Hello World\r\n", 13);
+    check("write", len == 13);
+    printf("write transactions=%lu\n", mock.getTransactions());
+    len = mock.drain(buffer, sizeof(buffer));
+    check("transmit", (len == 13) && (memcmp(buffer, "Hello World\r\n", 13) == 0));
+
+    /* Scatter-gather write. */
+    struct iovec iov[3];
+    iov[0].iov_base = (void *)"<hdr>";
+    iov[0].iov_len = 5;
+    iov[1].iov_base = (void *)"payload";
+    iov[1].iov_len = 7;
+    iov[2].iov_base = (void *)"</>";
+    iov[2].iov_len = 3;
+    sc16is750.rxEmptyFifo();
+    mock.resetTransactions();
+    len = sc16is750.writev(iov, 3);
+    printf("writev transactions=%lu\n", mock.getTransactions());
+    check("writev", (len == 15) && (mock.getTransactions() <= 2));
+    len = mock.drain(buffer, sizeof(buffer));
+    check("writev transmit", (len == 15) && (memcmp(buffer, "<hdr>payload</>", 15) == 0));
+
+    /* Receive and read. */
+    mock.inject("0123456789", 10);
+    check("rxAvailableData", sc16is750.rxAvailableData() == 10);
+    mock.resetTransactions();
+    len = sc16is750.read(buffer, sizeof(buffer));
+    check("read", (len == 10) && (memcmp(buffer, "0123456789", 10) == 0));
+    printf("read transactions=%lu\n", mock.getTransactions());
+
+    /* Loopback. */
+    sc16is750.enableLoopback();
+    sc16is750.write("loop", 4);
+    len = sc16is750.read(buffer, sizeof(buffer));
+    check("loopback", (len == 4) && (memcmp(buffer, "loop", 4) == 0));
+
+    /* Interrupts. */
+    sc16is750.init();
+    sc16is750.enableFifo(1);
+    sc16is750.rxFifoSetTriggerLevel(8);
+    sc16is750.setInterrupt(CONF_INT_RHREN);
+    sc16is750.intIsrDataReceived(&onDataReceived);
+    check("no interrupt", !mock.isIntPending());
+    mock.inject("interrupt", 9);
+    check("interrupt pending", mock.isIntPending());
+    while (mock.isIntPending()) {
+        sc16is750.pollInt();
+    }
+    check("data received", received == 9);
+
+    /* Read lines. */
+    const char *line;
+    char ring[16];
+    sc16is750.intIsrDataReceived(NULL);
+    mock.inject("hello\r\nworld\npartial", 20);
+    check("readLine", (sc16is750.readLine(&line) == 7) && (strcmp(line, "hello") == 0));
+    check("readLine lf", (sc16is750.readLine(&line) == 6) && (strcmp(line, "world") == 0));
+    check("readLine partial", sc16is750.readLine(&line) == 0);
+    check("readUntil", (sc16is750.readUntil('l', &line) == 7) && (memcmp(line, "partial", 7) == 0));
+    sc16is750.setRxBuffer(ring, sizeof(ring));
+    mock.inject("abcdefghij\nABCD", 15);
+    check("readLine ring", (sc16is750.readLine(&line) == 11) && (strcmp(line, "abcdefghij") == 0));
+    mock.inject("EFGHIJ\n", 7);
+    check("readLine wrap", (sc16is750.readLine(&line) == 11) && (strcmp(line, "ABCDEFGHIJ") == 0));
+    sc16is750.setRxBuffer(NULL, 0);
+    gnublin_irq_eventfd event;
+    sc16is750.setIrqSource(&event);
+    check("readLine timeout", sc16is750.readLine(&line, 50) == 0);
+
+    /* Blocking reads. */
+    mock.inject("blocking", 8);
+    check("readTimeout", (sc16is750.readTimeout(buffer, sizeof(buffer), 50) == 8) && (memcmp(buffer, "blocking", 8) == 0));
+    check("readTimeout no wait", sc16is750.readTimeout(buffer, sizeof(buffer), 0) == 0);
+    mock.inject("part", 4);
+    clock_t cpu = clock();
+    check("readExact partial", (sc16is750.readExact(buffer, 8, 50) == 4) && (memcmp(buffer, "part", 4) == 0));
+    printf("readExact cpu=%ldus\n", (long) ((clock() - cpu) * 1000000 / CLOCKS_PER_SEC));
+    check("readExact sleeps", clock() - cpu < CLOCKS_PER_SEC / 100);
+    mock.inject("exact", 5);
+    check("readExact", (sc16is750.readExact(buffer, 5) == 5) && (memcmp(buffer, "exact", 5) == 0));
+    sc16is750.setIrqSource(NULL);
+    check("readTimeout no irq", sc16is750.readTimeout(buffer, sizeof(buffer), 50) == -1);
+
+    /* RX timestamps and latency. */
+    sc16is750.init();
+    sc16is750.enableFifo(1);
+    sc16is750.rxFifoSetTriggerLevel(8);
+    sc16is750.setInterrupt(CONF_INT_RHREN);
+    sc16is750.setIrqSource(&event);
+    sc16is750.intIsrDataTimestamp(&onDataTimestamp);
+    sc16is750.resetRxLatency();
+    mock.inject("timestamp", 9);
+    event.trigger();
+    event.wait(0);
+    usleep(2000);
+    sc16is750.pollInt();
+    const sc16is7x0_histogram *latency = sc16is750.getRxLatency();
+    printf("latency count=%lu, min=%lu, max=%lu, p50=%lu, p99=%lu\n", latency->getCount(), latency->getMin(), latency->getMax(), latency->getPercentile(50), latency->getPercentile(99));
+    check("timestamped data", timestamped == 9);
+    check("latency from edge", (latency->getCount() == 1) && (latency->getMin() >= 2000) && (latency->getPercentile(99) <= latency->getMax()));
+    check("latency percentile", latency->getPercentile(50) >= latency->getMax() * 7 / 8);
+    sc16is7x0_histogram histogram;
+    for (unsigned long value = 1; value <= 1000; value++) {
+        histogram.record(value);
+    }
+    printf("histogram p50=%lu, p90=%lu, p99=%lu\n", histogram.getPercentile(50), histogram.getPercentile(90), histogram.getPercentile(99));
+    check("histogram percentiles", (histogram.getPercentile(50) >= 500) && (histogram.getPercentile(50) <= 500 * 9 / 8) && (histogram.getPercentile(99) >= 990) && (histogram.getPercentile(100) == 1000));
+    sc16is750.intIsrDataTimestamp(NULL);
+    sc16is750.setIrqSource(NULL);
+
+    /* Receiver line status errors. */
+    unsigned char errors[RX_BUFFER_SIZE];
+    sc16is750.init();
+    sc16is750.enableFifo(1);
+    sc16is750.rxFifoSetTriggerLevel(8);
+    sc16is750.setInterrupt(CONF_INT_RHREN | CONF_INT_RLSEN);
+    sc16is750.resetLineStats();
+    check("error buffer", sc16is750.setRxErrorBuffer(errors, sizeof(errors)) == 1);
+    mock.inject("clean", 5);
+    mock.injectError("P", 1, LSR_PARITY);
+    mock.injectError("\0", 1, LSR_BREAK | LSR_FRAMING);
+    mock.inject("tail", 4);
+    while (mock.isIntPending()) {
+        sc16is750.pollInt();
+    }
+    sc16is7x0_line_stats lineStats = sc16is750.getLineStats();
+    printf("line interrupts=%lu, overruns=%lu, parity=%lu, framing=%lu, breaks=%lu\n", lineStats.interrupts, lineStats.overruns, lineStats.parityErrors, lineStats.framingErrors, lineStats.breaks);
+    check("line status counters", (lineStats.parityErrors == 1) && (lineStats.framingErrors == 1) && (lineStats.breaks == 1) && (lineStats.overruns == 0));
+    unsigned char flags[16];
+    len = sc16is750.read(buffer, sizeof(buffer), flags);
+    check("line status data", (len == 11) && (memcmp(buffer, "cleanP\0tail", 11) == 0));
+    check("line status flags", (flags[0] == 0) && (flags[5] == LSR_PARITY) && (flags[6] == (LSR_BREAK | LSR_FRAMING)) && (flags[7] == 0));
+    mock.resetTransactions();
+    mock.inject("0123456789", 10);
+    while (mock.isIntPending()) {
+        sc16is750.pollInt();
+    }
+    check("clean data without LSR", mock.getTransactions() <= 3);
+    sc16is750.rxEmptyFifo();
+    memset(buffer, 'o', 80);
+    mock.inject(buffer, 80);
+    sc16is750.pollInt();
+    check("overrun", sc16is750.getLineStats().overruns == 1);
+    sc16is750.setRxErrorBuffer(NULL, 0);
+
+    /* RS-485 half-duplex. */
+    unsigned char efcr;
+    sc16is750.init();
+    sc16is750.enableFifo(1);
+    sc16is750.setBaudRate(UART_115200);
+    check("rs485", sc16is750.setRs485(CONF_RS485_AUTO | CONF_RS485_INVERT) == 1);
+    mock.receive(EFCRF, &efcr, 1);
+    check("rs485 efcr", efcr == 0x30);
+    check("rs485 rts flow rejected", sc16is750.setFlowControl(CONF_FLOW_RTS) < 0);
+    sc16is750.write("request", 7);
+    check("tx not complete", sc16is750.waitTxComplete(5) == 0);
+    mock.drain(buffer, sizeof(buffer));
+    check("tx complete", sc16is750.waitTxComplete(5) == 1);
+    sc16is750.setCrystalFrequency(XTAL_FREQ);
+    sc16is750.write("request", 7);
+    mock.resetTransactions();
+    check("tx not complete unknown baud", sc16is750.waitTxComplete(50) == 0);
+    printf("waitTxComplete transactions=%lu\n", mock.getTransactions());
+    check("tx complete polling bounded", mock.getTransactions() <= 4);
+    mock.drain(buffer, sizeof(buffer));
+    sc16is750.setRs485(CONF_RS485_NONE);
+
+    /* CTS and modem status. */
+    char message[100];
+    memset(message, 'c', sizeof(message));
+    sc16is750.init();
+    sc16is750.enableFifo(1);
+    sc16is750.setFlowControl(CONF_FLOW_CTS);
+    sc16is750.enableTxBuffer(1);
+    sc16is750.intIsrModem(&onModem);
+    sc16is750.setInterrupt(CONF_INT_RHREN | CONF_INT_MSEN);
+    check("cts active", sc16is750.isCtsActive() == 1);
+    mock.setCts(0);
+    check("modem interrupt", (sc16is750.pollInt() == 1) && (modemCount == 1) && (sc16is750.isCtsActive() == 0));
+    mock.resetTransactions();
+    check("tx parked write", sc16is750.write(message, sizeof(message)) == sizeof(message));
+    check("tx parked", (mock.getTransactions() == 0) && (mock.txLevel() == 0));
+    mock.setCts(1);
+    sc16is750.pollInt();
+    check("tx resumed", (modemCount == 2) && (mock.txLevel() == FIFO_SIZE));
+    len = 0;
+    while (sc16is750.txBufferedData() > 0) {
+        len += mock.drain(buffer, sizeof(buffer));
+        sc16is750.pollInt();
+    }
+    len += mock.drain(buffer, sizeof(buffer));
+    check("tx complete after cts", len == sizeof(message));
+    sc16is750.intIsrModem(NULL);
+    sc16is750.enableTxBuffer(0);
+
+    /* Software flow control. */
+    sc16is750.init();
+    sc16is750.enableFifo(1);
+    sc16is750.setFlowControl(CONF_FLOW_XONXOFF);
+    sc16is750.setXonXoff(XON_DEFAULT, XOFF_DEFAULT);
+    sc16is750.setFlowTriggers(8, 16);
+    sc16is750.setInterrupt(CONF_INT_XOFFEN);
+    sc16is750.intIsrXoff(&onXoff);
+    check("flow control", !sc16is750.fail());
+    mock.inject("0123456789abcdef", 16);
+    check("xoff sent", (mock.drain(buffer, sizeof(buffer)) == 1) && (buffer[0] == XOFF_DEFAULT));
+    sc16is750.rxEmptyFifo();
+    check("xon sent", (mock.drain(buffer, sizeof(buffer)) == 1) && (buffer[0] == XON_DEFAULT));
+    buffer[0] = XOFF_DEFAULT;
+    mock.inject(buffer, 1);
+    sc16is750.pollInt();
+    check("xoff received", xoffCount == 1);
+    sc16is750.write("x", 1);
+    check("transmission halted", mock.drain(buffer, sizeof(buffer)) == 0);
+    buffer[0] = XON_DEFAULT;
+    mock.inject(buffer, 1);
+    check("transmission resumed", mock.drain(buffer, sizeof(buffer)) == 1);
+
+    /* Special character detection, a single wakeup per line. */
+    sc16is750.init();
+    sc16is750.enableFifo(1);
+    sc16is750.setInterrupt(CONF_INT_XOFFEN);
+    xoffCount = 0;
+    check("special char", (sc16is750.setSpecialChar('\n') == 1) && (sc16is750.getSpecialChar() == '\n'));
+    check("special char flow control", sc16is750.setFlowControl(CONF_FLOW_RX_XON2) < 0);
+    sc16is750.resetIntStats();
+    mock.inject("partial ", 8);
+    check("no wakeup before terminator", !mock.isIntPending());
+    mock.inject("line\n", 5);
+    check("wakeup on terminator", (sc16is750.pollInt() == 1) && (xoffCount == 1) && !mock.isIntPending());
+    check("line received", (sc16is750.read(buffer, sizeof(buffer)) == 13) && (memcmp(buffer, "partial line\n", 13) == 0));
+    check("single wakeup", sc16is750.getIntStats().rxInterrupts == 1);
+    sc16is7x0_uart_config defaults;
+    defaults.fifoEnable = 1;
+    defaults.interrupt = CONF_INT_XOFFEN;
+    check("special char configure", (sc16is750.configure(&defaults) > 0) && (sc16is750.getSpecialChar() == '\n'));
+    defaults.flow = CONF_FLOW_RX_XON2;
+    check("special char configure flow control", sc16is750.configure(&defaults) < 0);
+    defaults.flow = CONF_FLOW_DISABLED;
+    mock.inject("kept\n", 5);
+    check("special char kept", (sc16is750.pollInt() == 1) && (xoffCount == 2));
+    sc16is750.read(buffer, sizeof(buffer));
+    mock.inject("early\n", 6);
+    sc16is750.read(buffer, sizeof(buffer));
+    check("special char drained before service", (sc16is750.pollInt() == 1) && (sc16is750.read(buffer, sizeof(buffer)) == 0));
+    gnublin_module_sc16is750 other;
+    other.setTransport(&mock);
+    other.syncConfig();
+    other.setSpecialChar('\r');
+    check("sync xoff", (sc16is750.syncConfig() == 1) && (sc16is750.getSpecialChar() == '\r'));
+    sc16is750.setSpecialChar('\n');
+    mock.inject("synced\n", 7);
+    check("special char after sync", (sc16is750.pollInt() == 1) && (xoffCount == 4));
+    sc16is750.read(buffer, sizeof(buffer));
+    sc16is750.setIrqSource(&event);
+    mock.inject("wait\n", 5);
+    check("readLine special char", (sc16is750.readLine(&line, 50) == 5) && (strcmp(line, "wait") == 0));
+    check("readLine special char timeout", sc16is750.readLine(&line, 50) == 0);
+    sc16is750.setIrqSource(NULL);
+    check("special char disabled", (sc16is750.setSpecialChar(SPECIAL_CHAR_NONE) == 1) && (sc16is750.getSpecialChar() == SPECIAL_CHAR_NONE));
+    sc16is750.intIsrXoff(NULL);
+
+    /* Multidrop mode, the frames for the other nodes are discarded by the
+       chip. */
+    sc16is750.init();
+    sc16is750.enableFifo(1);
+    sc16is750.rxFifoSetTriggerLevel(8);
+    sc16is750.setInterrupt(CONF_INT_RHREN | CONF_INT_RLSEN);
+    sc16is750.setRxErrorBuffer(errors, sizeof(errors));
+    sc16is750.resetLineStats();
+    check("multidrop", (sc16is750.setMultidrop(0x42) == 1) && (sc16is750.getMultidrop() == 0x42) && (sc16is750.getSpecialChar() == SPECIAL_CHAR_NONE));
+    check("multidrop special char", sc16is750.setSpecialChar('\n') < 0);
+    check("multidrop special char none", (sc16is750.setSpecialChar(SPECIAL_CHAR_NONE) == 1) && (sc16is750.getMultidrop() == 0x42));
+    mock.resetTransactions();
+    mock.injectAddress(0x17);
+    mock.inject("foreign", 7);
+    check("foreign frame discarded", !mock.isIntPending() && (mock.getTransactions() == 0));
+    mock.injectAddress(0x42);
+    mock.inject("own", 3);
+    while (mock.isIntPending()) {
+        sc16is750.pollInt();
+    }
+    lineStats = sc16is750.getLineStats();
+    len = sc16is750.read(buffer, sizeof(buffer), flags);
+    check("own frame", (len == 4) && (buffer[0] == 0x42) && (memcmp(buffer + 1, "own", 3) == 0) && (flags[0] == LSR_PARITY) && (flags[1] == 0));
+    check("address counted", (lineStats.addresses == 1) && (lineStats.parityErrors == 0));
+    mock.injectAddress(0x17);
+    mock.inject("foreign", 7);
+    check("receiver disabled again", !mock.isIntPending());
+    defaults.interrupt = CONF_INT_RHREN | CONF_INT_RLSEN;
+    check("multidrop configure", (sc16is750.configure(&defaults) > 0) && (sc16is750.getMultidrop() == 0x42));
+    mock.injectAddress(0x17);
+    mock.inject("foreign", 7);
+    mock.injectAddress(0x42);
+    mock.inject("own", 3);
+    while (mock.isIntPending()) {
+        sc16is750.pollInt();
+    }
+    len = sc16is750.read(buffer, sizeof(buffer), flags);
+    check("multidrop kept", (len == 4) && (buffer[0] == 0x42) && (flags[0] == LSR_PARITY) && (flags[1] == 0));
+    check("multidrop disabled", (sc16is750.setMultidrop(MULTIDROP_NONE) == 1) && (sc16is750.getMultidrop() == MULTIDROP_NONE));
+    sc16is750.setRxErrorBuffer(NULL, 0);
+
+    /* Adaptive trigger levels. */
+    sc16is750.init();
+    sc16is750.enableFifo(1);
+    sc16is750.setBaudRate(UART_115200);
+    sc16is750.rxFifoSetTriggerLevel(16);
+    sc16is750.setInterrupt(CONF_INT_RHREN);
+    sc16is750.resetIntStats();
+    check("adaptive trigger", sc16is750.setAdaptiveTrigger(1, 1000, 2000) == 1);
+    mock.inject("0123456789abcdef", 16);
+    sc16is750.pollInt();
+    usleep((ADAPTIVE_WINDOW + 10) * 1000);
+    mock.inject("0123456789abcdef", 16);
+    sc16is750.pollInt();
+    sc16is7x0_int_stats stats = sc16is750.getIntStats();
+    printf("rxIntRate=%.1f, rxBytesPerInt=%.1f\n", stats.rxIntRate, stats.rxBytesPerInt);
+    check("adaptive counters", (stats.rxInterrupts == 2) && (stats.rxBytes == 32));
+    check("adaptive lower", (sc16is750.rxFifoGetTriggerLevel() == 12) && (stats.adjustments == 1));
+    sc16is750.setAdaptiveTrigger(1, 10, 2000);
+    mock.inject("0123456789ab", 12);
+    sc16is750.pollInt();
+    usleep((ADAPTIVE_WINDOW + 10) * 1000);
+    mock.inject("0123456789ab", 12);
+    sc16is750.pollInt();
+    check("adaptive raise bounded by latency", sc16is750.rxFifoGetTriggerLevel() == 20);
+    sc16is750.setAdaptiveTrigger(0);
+
+    /* RX polling, a single interrupt for a burst. */
+    sc16is750.init();
+    sc16is750.enableFifo(1);
+    sc16is750.rxFifoSetTriggerLevel(8);
+    sc16is750.setInterrupt(CONF_INT_RHREN);
+    sc16is750.read(buffer, sizeof(buffer));
+    sc16is750.resetIntStats();
+    check("rx polling", sc16is750.setRxPolling(1, 2) == 1);
+    mock.inject("0123456789abcdef", 16);
+    check("polling entered", (sc16is750.pollInt() == 1) && (sc16is750.getPollTimeout() == RX_POLL_INTERVAL));
+    mock.inject("0123456789abcdef", 16);
+    check("no interrupt while polling", !mock.isIntPending());
+    mock.resetTransactions();
+    check("data polled", (sc16is750.pollInt() == 1) && (mock.getTransactions() == 2));
+    check("empty poll", (sc16is750.pollInt() == 0) && (sc16is750.getPollTimeout() == RX_POLL_INTERVAL));
+    check("interrupt enabled again", (sc16is750.pollInt() == 0) && (sc16is750.getPollTimeout() == -1));
+    stats = sc16is750.getIntStats();
+    check("polling counters", (stats.rxInterrupts == 1) && (stats.rxBytes == 32) && (stats.rxPolls == 3));
+    check("polled data", sc16is750.read(buffer, sizeof(buffer)) == 32);
+    mock.inject("x", 1);
+    check("interrupt after polling", mock.isIntPending() && (sc16is750.pollInt() == 1));
+    sc16is750.read(buffer, sizeof(buffer));
+
+    /* RX polling with the TX ring buffer, the THR interrupt toggles keep
+       polling. */
+    char burst[200];
+    memset(burst, 't', sizeof(burst));
+    sc16is750.enableTxBuffer(1);
+    mock.inject("0123456789abcdef", 16);
+    check("polling with tx buffer", (sc16is750.pollInt() == 1) && (sc16is750.getPollTimeout() == RX_POLL_INTERVAL));
+    check("tx buffer write", sc16is750.write(burst, sizeof(burst)) == sizeof(burst));
+    mock.inject("0123456789abcdef", 16);
+    check("polling kept by tx", (sc16is750.getPollTimeout() == RX_POLL_INTERVAL) && !mock.isIntPending());
+    len = 0;
+    while (sc16is750.txBufferedData() > 0) {
+        len += mock.drain(buffer, sizeof(buffer));
+        sc16is750.pollInt();
+    }
+    len += mock.drain(buffer, sizeof(buffer));
+    check("tx complete while polling", len == sizeof(burst));
+    check("rx polled with tx", sc16is750.read(buffer, sizeof(buffer)) == 32);
+    sc16is750.enableTxBuffer(0);
+
+    /* The RX polling is left by configure, the RHR interrupt is not enabled
+       again. */
+    sc16is7x0_uart_config polled;
+    polled.baudRate = UART_115200;
+    polled.fifoEnable = 1;
+    polled.interrupt = CONF_INT_RHREN;
+    sc16is750.configure(&polled);
+    mock.inject("0123456789abcdef", 16);
+    check("polling before configure", (sc16is750.pollInt() == 1) && (sc16is750.getPollTimeout() == RX_POLL_INTERVAL));
+    sc16is750.read(buffer, sizeof(buffer));
+    polled.interrupt = CONF_INT_NONE;
+    sc16is750.configure(&polled);
+    check("polling left by configure", sc16is750.getPollTimeout() == -1);
+    for (int i = 0; i < 4; i++) {
+        sc16is750.pollInt();
+    }
+    mock.inject("x", 1);
+    check("no interrupt after configure", !mock.isIntPending());
+    sc16is750.read(buffer, sizeof(buffer));
+    sc16is750.setRxPolling(0);
+
+    /* Scheduler with a busy chip. */
+    sc16is7x0_transport_mock mocks[2];
+    gnublin_module_sc16is750 uarts[2];
+    sc16is7x0_scheduler scheduler(16);
+    for (int i = 0; i < 2; i++) {
+        uarts[i].setTransport(&mocks[i]);
+        uarts[i].init();
+        uarts[i].enableFifo(1);
+        uarts[i].rxFifoSetTriggerLevel(8);
+        uarts[i].setInterrupt(CONF_INT_RHREN);
+        scheduler.add(&uarts[i]);
+    }
+    scheduler.add(&sc16is750);
+    sc16is750.rxEmptyFifo();
+    check("scheduler idle", scheduler.pollInt() == 0);
+    mocks[0].inject("0123456789012345678901234567890123456789", 40);
+    mocks[1].inject("abcdefghij", 10);
+    check("scheduler pass", scheduler.pollInt() == 2);
+    check("scheduler budget", (uarts[0].rxAvailableData() == 40) && (mocks[0].rxLevel() == 24));
+    check("scheduler fair", uarts[1].rxAvailableData() == 10);
+    while (scheduler.pollInt() > 0);
+    check("scheduler drained", (mocks[0].rxLevel() == 0) && (scheduler.getPasses() == 5));
+    scheduler.remove(&sc16is750);
+
+    /* Service budget with a reactor, the data left in the RX FIFO is
+       serviced without a new edge. */
+    gnublin_irq_reactor reactor;
+    sc16is750.init();
+    sc16is750.enableFifo(1);
+    sc16is750.rxFifoSetTriggerLevel(8);
+    sc16is750.setInterrupt(CONF_INT_RHREN);
+    sc16is750.setServiceBudget(2);
+    reactor.add(&sc16is750, &event);
+    memset(burst, 'b', sizeof(burst));
+    mock.inject(burst, FIFO_SIZE);
+    sc16is750.pollInt();
+    check("budget poll timeout", (sc16is750.getPollTimeout() == 0) && mock.isIntPending());
+    event.trigger();
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; (i < 4) && (mock.rxLevel() > 0); i++) {
+        reactor.wait(200);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    check("budget drained after one edge", (mock.rxLevel() == 0) && !mock.isIntPending() && (sc16is750.getPollTimeout() == -1));
+    check("budget drained without timeout", (end.tv_sec - start.tv_sec) * 1000 + (end.tv_nsec - start.tv_nsec) / 1000000 < 100);
+    check("budget data", sc16is750.read(buffer, sizeof(buffer)) == FIFO_SIZE);
+    reactor.remove(&sc16is750);
+    sc16is750.setServiceBudget(0);
+    sc16is750.setIrqSource(NULL);
+
+    /* GPIO */
+    sc16is750.pinMode(0, OUTPUT);
+    sc16is750.digitalWrite(0, HIGH);
+    check("gpio", sc16is750.digitalRead(0) == HIGH);
+
+    printf("%d failure(s)\n", failures);
+    return (failures == 0) ? 0 : 1;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* test_sc16is7x0_mock.c ends here */
@@ -0,0 +1,506 @@
+// module_xbee.cpp --- 
+// 
+// Filename     : module_xbee.cpp
+// Description  : Class for encoding and decoding XBee API frames.
+// Author       : Christophe Burki
+// Maintainer   : Christophe Burki
+// Created      : Sat Oct 17 14:23:52 2026
+// Version      : 1.0.0
+// Last-Updated : 
+//           By : 
+//     Update # : 0
+// URL          : 
+// Keywords     : 
+// Compatibility: 
+// 
+// 
+
+// Commentary   : 
+// 
+// 
+// 
+// 
+
+// Change log:
+// 
+// 
+// 
+// 
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 3 as
+// published by the Free Software Foundation.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program; see the file LICENSE.  If not, write to the
+// Free Software Foundation, Inc., 51 Franklin Street, Fifth
+// ;; Floor, Boston, MA 02110-1301, USA.
+// 
+// 
+
+// Code         :
+
+/* -------------------------------------------------------------------------- */
+
+#include "module_xbee.h"
+
+/* -------------------------------------------------------------------------- */
+
+/* Decoder states. */
+#define DECODE_IDLE       0  /* Waiting for the start delimiter. */
+#define DECODE_LENGTH_MSB 1
+#define DECODE_LENGTH_LSB 2
+#define DECODE_DATA       3
+#define DECODE_CHECKSUM   4
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @~english
+ * @brief Append a byte to the encoded frame, escaping it when needed.
+ *
+ * @param buffer The encoded frame.
+ * @param size The size of the buffer.
+ * @param pos The position of the byte in the buffer, updated.
+ * @param value The byte to append.
+ * @return -1 when the buffer is too small and 1 on success.
+ */
+static int putEscaped(unsigned char *buffer, unsigned int size, unsigned int *pos, unsigned char value) {
+
+    if ((value == XBEE_START) || (value == XBEE_ESCAPE) || (value == XBEE_XON) || (value == XBEE_XOFF)) {
+        if (*pos + 2 > size) {
+            return -1;
+        }
+        buffer[(*pos)++] = XBEE_ESCAPE;
+        buffer[(*pos)++] = value ^ XBEE_ESCAPE_XOR;
+        return 1;
+    }
+
+    if (*pos + 1 > size) {
+        return -1;
+    }
+    buffer[(*pos)++] = value;
+    return 1;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @~english
+ * @brief Reset the decoder.
+ */
+gnublin_module_xbee::gnublin_module_xbee(void) {
+
+    errorFlag = false;
+    uart = NULL;
+    isrFrameReceived = NULL;
+    isrFrameReceivedContext = NULL;
+
+    reset();
+}
+
+
+/**
+ * @~english
+ * @brief Get the last error message.
+ *
+ * @return The error message as c-string.
+ */
+const char* gnublin_module_xbee::getErrorMessage(void) {
+
+    return errorMessage.c_str();
+}
+
+
+/**
+ * @~english
+ * @brief Return whether the action fail or not.
+ *
+ * @return A boolean value indicating if the action fail or not.
+ */
+bool gnublin_module_xbee::fail(void) {
+
+    return errorFlag;
+}
+
+
+/**
+ * @~english
+ * @brief Attach the decoder to the given UART. The data received by the
+ * UART is decoded in its data received ISR, directly from its RX ring
+ * buffer. The frames are sent to this UART.
+ *
+ * @param uart The UART.
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_module_xbee::attach(gnublin_module_sc16is7x0 *uart) {
+
+    errorFlag = false;
+
+    if (uart == NULL) {
+        errorFlag = true;
+        errorMessage = "UART is NULL\n";
+        return -1;
+    }
+
+    this->uart = uart;
+    return uart->intIsrDataReceived(&dataReceived, this);
+}
+
+
+/**
+ * @~english
+ * @brief Reset the decoder and the counters. A partially received frame is
+ * discarded.
+ */
+void gnublin_module_xbee::reset(void) {
+
+    state = DECODE_IDLE;
+    escaped = 0;
+    length = 0;
+    count = 0;
+    checksum = 0;
+
+    frames = 0;
+    checksumErrors = 0;
+    frameErrors = 0;
+}
+
+
+/**
+ * @~english
+ * @brief Decode the given chunk of data. The complete frames are given to
+ * the frame received ISR. A frame could be split across any number of
+ * chunks.
+ *
+ * @param buffer The data to decode.
+ * @param len The length of the data.
+ * @return The number of valid frames received.
+ */
+int gnublin_module_xbee::decode(const char *buffer, unsigned int len) {
+
+    errorFlag = false;
+    const unsigned char *data = (const unsigned char *)buffer;
+    unsigned long received = frames;
+
+    for (unsigned int i = 0; i < len; i++) {
+        unsigned char value = data[i];
+
+        if (value == XBEE_START) {
+            if (state != DECODE_IDLE) {
+                /* The previous frame is interrupted. */
+                frameErrors++;
+            }
+
+            int used = decodeDirect(data + i, len - i);
+            if (used > 0) {
+                state = DECODE_IDLE;
+                i += used - 1;
+                continue;
+            }
+
+            state = DECODE_LENGTH_MSB;
+            escaped = 0;
+            continue;
+        }
+
+        if (state == DECODE_IDLE) {
+            /* Skip the data until the start delimiter. */
+            continue;
+        }
+
+        if (value == XBEE_ESCAPE) {
+            escaped = 1;
+            continue;
+        }
+
+        if (escaped == 1) {
+            value ^= XBEE_ESCAPE_XOR;
+            escaped = 0;
+        }
+
+        switch (state) {
+        case DECODE_LENGTH_MSB :
+            length = value << 8;
+            state = DECODE_LENGTH_LSB;
+            break;
+        case DECODE_LENGTH_LSB :
+            length |= value;
+            if ((length == 0) || (length > XBEE_MAX_FRAME)) {
+                frameErrors++;
+                state = DECODE_IDLE;
+                break;
+            }
+            count = 0;
+            checksum = 0;
+            state = DECODE_DATA;
+            break;
+        case DECODE_DATA :
+            frame[count++] = value;
+            checksum += value;
+            if (count == length) {
+                state = DECODE_CHECKSUM;
+            }
+            break;
+        case DECODE_CHECKSUM :
+            frameReceived(frame, length, checksum + value);
+            state = DECODE_IDLE;
+            break;
+        default :
+            state = DECODE_IDLE;
+            break;
+        }
+    }
+
+    return frames - received;
+}
+
+
+/**
+ * @~english
+ * @brief Encode the given frame data.
+ *
+ * @param data The frame data (API identifier and payload).
+ * @param len The length of the frame data.
+ * @param buffer The encoded frame (at most XBEE_MAX_ENCODED bytes).
+ * @param size The size of the buffer.
+ * @return -1 on error and the length of the encoded frame on success.
+ */
+int gnublin_module_xbee::encode(const unsigned char *data, unsigned int len, unsigned char *buffer, unsigned int size) {
+
+    errorFlag = false;
+    unsigned int pos = 0;
+    unsigned char sum = 0;
+    int ret = 1;
+
+    if ((len == 0) || (len > XBEE_MAX_FRAME)) {
+        errorFlag = true;
+        errorMessage = "Frame length is not between 1 and XBEE_MAX_FRAME\n";
+        return -1;
+    }
+
+    if (size < 1) {
+        errorFlag = true;
+        errorMessage = "Buffer is too small\n";
+        return -1;
+    }
+
+    buffer[pos++] = XBEE_START;
+    ret = putEscaped(buffer, size, &pos, (len >> 8) & 0xff);
+    if (ret > 0) {
+        ret = putEscaped(buffer, size, &pos, len & 0xff);
+    }
+    for (unsigned int i = 0; (ret > 0) && (i < len); i++) {
+        sum += data[i];
+        ret = putEscaped(buffer, size, &pos, data[i]);
+    }
+    if (ret > 0) {
+        ret = putEscaped(buffer, size, &pos, 0xff - sum);
+    }
+
+    if (ret < 0) {
+        errorFlag = true;
+        errorMessage = "Buffer is too small\n";
+        return -1;
+    }
+
+    return pos;
+}
+
+
+/**
+ * @~english
+ * @brief Encode the given frame data and write it to the attached UART.
+ * Nothing is written when the TX ring buffer of the UART has no room for
+ * the whole frame (see gnublin_module_sc16is7x0::enableTxBuffer), the send
+ * could be retried later.
+ *
+ * @param data The frame data (API identifier and payload).
+ * @param len The length of the frame data.
+ * @return -1 on error and 1 on success.
+ */
+int gnublin_module_xbee::send(const unsigned char *data, unsigned int len) {
+
+    unsigned char buffer[XBEE_MAX_ENCODED];
+    int encoded;
+    int written;
+
+    if ((encoded = encode(data, len, buffer, sizeof(buffer))) < 0) {
+        return -1;
+    }
+
+    if (uart == NULL) {
+        errorFlag = true;
+        errorMessage = "No UART attached\n";
+        return -1;
+    }
+
+    /* A partial frame must not be queued for the line. */
+    if (TX_BUFFER_SIZE - uart->txBufferedData() < encoded) {
+        errorFlag = true;
+        errorMessage = "No room for the frame in the TX buffer\n";
+        return -1;
+    }
+
+    if ((written = uart->write((const char *)buffer, encoded)) < 0) {
+        errorFlag = true;
+        errorMessage = uart->getErrorMessage();
+        return -1;
+    }
+
+    if (written < encoded) {
+        errorFlag = true;
+        errorMessage = "Frame not completely written\n";
+        return -1;
+    }
+
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Register an Interrupt Service Routine that will be called when
+ * a valid frame is received.
+ *
+ * @param isr Callback function that will be called on interrupt. The frame
+ * is a view of the frame data (API identifier and payload), it is only
+ * valid during the call.
+ * @param context The context given to the ISR.
+ *
+ * isr(const unsigned char *frame, int len, void *context)
+ */
+int gnublin_module_xbee::intIsrFrameReceived(void (*isr)(const unsigned char *, int, void *), void *context) {
+
+    isrFrameReceived = isr;
+    isrFrameReceivedContext = context;
+    return 1;
+}
+
+
+/**
+ * @~english
+ * @brief Get the number of valid frames received.
+ *
+ * @return The number of frames.
+ */
+unsigned long gnublin_module_xbee::getFrames(void) {
+
+    return frames;
+}
+
+
+/**
+ * @~english
+ * @brief Get the number of frames received with a wrong checksum.
+ *
+ * @return The number of frames.
+ */
+unsigned long gnublin_module_xbee::getChecksumErrors(void) {
+
+    return checksumErrors;
+}
+
+
+/**
+ * @~english
+ * @brief Get the number of frames with an invalid length or interrupted by
+ * a start delimiter.
+ *
+ * @return The number of frames.
+ */
+unsigned long gnublin_module_xbee::getFrameErrors(void) {
+
+    return frameErrors;
+}
+
+
+/**
+ * @~english
+ * @brief Decode a frame fully contained in the given data and without
+ * escaped bytes. The frame is given to the ISR as a view in the data, the
+ * checksum is computed while searching for escaped bytes.
+ *
+ * @param buffer The data starting with the start delimiter.
+ * @param len The length of the data.
+ * @return The number of bytes used or 0 when the frame must be decoded by
+ * the state machine.
+ */
+int gnublin_module_xbee::decodeDirect(const unsigned char *buffer, unsigned int len) {
+
+    unsigned int frameLen;
+    unsigned char sum = 0;
+
+    if (len < 5) {
+        return 0;
+    }
+
+    for (unsigned int i = 1; i < 3; i++) {
+        if ((buffer[i] == XBEE_START) || (buffer[i] == XBEE_ESCAPE)) {
+            return 0;
+        }
+    }
+
+    frameLen = (buffer[1] << 8) | buffer[2];
+    if ((frameLen == 0) || (frameLen > XBEE_MAX_FRAME) || (frameLen + 4 > len)) {
+        return 0;
+    }
+
+    /* Frame data and checksum. */
+    for (unsigned int i = 3; i < frameLen + 4; i++) {
+        if ((buffer[i] == XBEE_START) || (buffer[i] == XBEE_ESCAPE)) {
+            return 0;
+        }
+        sum += buffer[i];
+    }
+
+    frameReceived(buffer + 3, frameLen, sum);
+    return frameLen + 4;
+}
+
+
+/**
+ * @~english
+ * @brief Count the received frame and give it to the ISR when its checksum
+ * is valid.
+ *
+ * @param data The frame data.
+ * @param len The length of the frame data.
+ * @param sum The 8 bits sum of the frame data and of the checksum.
+ */
+void gnublin_module_xbee::frameReceived(const unsigned char *data, unsigned int len, unsigned char sum) {
+
+    if (sum != 0xff) {
+        checksumErrors++;
+        return;
+    }
+
+    frames++;
+    if (isrFrameReceived != NULL) {
+        isrFrameReceived(data, len, isrFrameReceivedContext);
+    }
+}
+
+
+/**
+ * @~english
+ * @brief Data received ISR of the attached UART.
+ *
+ * @param buffer The data received, a view in the RX ring buffer.
+ * @param len The length of the data.
+ * @param context The decoder.
+ */
+void gnublin_module_xbee::dataReceived(const char *buffer, int len, void *context) {
+
+    ((gnublin_module_xbee *)context)->decode(buffer, len);
+}
+
+/* -------------------------------------------------------------------------- */
+
+// 
+// module_xbee.cpp ends here
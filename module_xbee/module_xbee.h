@@ -0,0 +1,133 @@
+/* module_xbee.h --- 
+ * 
+ * Filename     : module_xbee.h
+ * Description  : Class for encoding and decoding XBee API frames.
+ * Author       : Christophe Burki
+ * Maintainer   : Christophe Burki
+ * Created      : Sat Oct 17 14:21:07 2026
+ * Version      : 1.0.0
+ * Last-Updated : 
+ *           By : 
+ *     Update # : 0
+ * URL          : 
+ * Keywords     : 
+ * Compatibility: 
+ * 
+ */
+
+/* Commentary   : 
+ *
+ * XBee API frame (API mode 2, escaped)
+ *
+ * | 0x7E | Length MSB | Length LSB | Frame data ... | Checksum |
+ *
+ * The length is the number of bytes of the frame data (API identifier and
+ * payload). The checksum is 0xFF minus the 8 bits sum of the frame data.
+ * All the bytes but the start delimiter are escaped : 0x7E, 0x7D, 0x11 and
+ * 0x13 are sent as 0x7D followed by the byte XORed with 0x20. An unescaped
+ * 0x7E always starts a new frame.
+ *
+ * The decoder is fed with the chunks of data received from the UART, the
+ * frames could be split across any number of chunks. A frame fully
+ * contained in a chunk and without escaped bytes is given to the frame
+ * received ISR as a view in the chunk. The other frames are unescaped in
+ * the frame buffer of the decoder. The checksum is computed while
+ * unescaping.
+ *
+ */
+
+/* Change log:
+ * 
+ * 
+ */
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as 
+ * published by the Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file LICENSE.  If not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth
+ * ;; Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* Code         : */
+
+#ifndef GNUBLIN_MODULE_XBEE
+#define GNUBLIN_MODULE_XBEE
+
+/* -------------------------------------------------------------------------- */
+
+#include "gnublin.h"
+#include "module_sc16is7x0.h"
+
+/* -------------------------------------------------------------------------- */
+
+#define XBEE_START      0x7e  /* Start delimiter. */
+#define XBEE_ESCAPE     0x7d  /* Escape character. */
+#define XBEE_XON        0x11
+#define XBEE_XOFF       0x13
+#define XBEE_ESCAPE_XOR 0x20  /* Value XORed with the escaped bytes. */
+
+#define XBEE_MAX_FRAME   256                          /* Maximum length of the frame data. */
+#define XBEE_MAX_ENCODED (1 + 2 * (XBEE_MAX_FRAME + 3))  /* Maximum length of an encoded frame. */
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @class gnublin_module_xbee
+ * @~english
+ * @brief Class for encoding and decoding XBee API frames (escaped mode)
+ * exchanged over a SC16IS7x0 UART.
+ */
+class gnublin_module_xbee {
+
+ protected :
+    bool errorFlag;
+    std::string errorMessage;
+
+    gnublin_module_sc16is7x0 *uart;
+
+    int state;              /* Decoder state. */
+    int escaped;            /* Whether the next byte is escaped. */
+    unsigned int length;    /* Length of the frame data. */
+    unsigned int count;     /* Number of bytes of frame data received. */
+    unsigned char checksum; /* Sum of the frame data received. */
+    unsigned char frame[XBEE_MAX_FRAME];
+
+    unsigned long frames;
+    unsigned long checksumErrors;
+    unsigned long frameErrors;
+
+    void (*isrFrameReceived)(const unsigned char *, int, void *);
+    void *isrFrameReceivedContext;
+
+    int decodeDirect(const unsigned char *buffer, unsigned int len);
+    void frameReceived(const unsigned char *data, unsigned int len, unsigned char sum);
+    static void dataReceived(const char *buffer, int len, void *context);
+
+ public :
+    gnublin_module_xbee(void);
+    const char* getErrorMessage(void);
+    bool fail(void);
+    int attach(gnublin_module_sc16is7x0 *uart);
+    void reset(void);
+    int decode(const char *buffer, unsigned int len);
+    int encode(const unsigned char *data, unsigned int len, unsigned char *buffer, unsigned int size);
+    int send(const unsigned char *data, unsigned int len);
+    int intIsrFrameReceived(void (*isr)(const unsigned char *, int, void *), void *context = NULL);
+    unsigned long getFrames(void);
+    unsigned long getChecksumErrors(void);
+    unsigned long getFrameErrors(void);
+};
+
+/* -------------------------------------------------------------------------- */
+
+#endif
+
+/* module_xbee.h ends here */
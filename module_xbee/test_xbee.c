@@ -0,0 +1,150 @@
+/* test_xbee.c --- 
+ * 
+ * Filename     : test_xbee.c
+ * Description  : Test the XBee API frames codec with the mock transport.
+ * Author       : Christophe Burki
+ * Maintainer   : Christophe Burki
+ * Created      : Sat Oct 17 14:40:12 2026
+ * Version      : 1.0.0
+ * Last-Updated : 
+ *           By : 
+ *     Update # : 0
+ * URL          : 
+ * Keywords     : 
+ * Compatibility: 
+ * 
+ */
+
+/* Commentary   : 
+ * 
+ * 
+ * 
+ */
+
+/* Change log:
+ * 
+ * 
+ */
+
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as 
+ * published by the Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file LICENSE.  If not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth
+ * ;; Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* Code         : */
+/* -------------------------------------------------------------------------- */
+
+#include <stdio.h>
+
+#include "gnublin.h"
+#include "module_sc16is750.h"
+#include "module_xbee.h"
+
+/* -------------------------------------------------------------------------- */
+
+int failures = 0;
+
+void check(const char *name, int condition) {
+
+    printf("%s : %s\n", condition ? "PASS" : "FAIL", name);
+    if (!condition) {
+        failures++;
+    }
+}
+
+
+unsigned char lastFrame[XBEE_MAX_FRAME];
+int lastLen = 0;
+
+void onFrameReceived(const unsigned char *frame, int len, void *context) {
+    printf("onFrameReceived(id=0x%02x, len=%d)\n", frame[0], len);
+    memcpy(lastFrame, frame, len);
+    lastLen = len;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int main(void) {
+    printf("Testing the XBee API frames codec.\n");
+
+    gnublin_module_xbee xbee;
+    unsigned char buffer[XBEE_MAX_ENCODED];
+    int len;
+
+    xbee.intIsrFrameReceived(&onFrameReceived);
+
+    /* AT command frame (ATNI) from the XBee documentation. */
+    const unsigned char atni[] = {0x08, 0x01, 0x4e, 0x49};
+    const unsigned char atniEncoded[] = {0x7e, 0x00, 0x04, 0x08, 0x01, 0x4e, 0x49, 0x5f};
+    len = xbee.encode(atni, sizeof(atni), buffer, sizeof(buffer));
+    check("encode", (len == sizeof(atniEncoded)) && (memcmp(buffer, atniEncoded, len) == 0));
+    check("decode", (xbee.decode((const char *)buffer, len) == 1) && (lastLen == 4) && (memcmp(lastFrame, atni, 4) == 0));
+
+    /* Escaped bytes. */
+    const unsigned char escape[] = {0x10, 0x7e, 0x7d, 0x11, 0x13, 0x42};
+    len = xbee.encode(escape, sizeof(escape), buffer, sizeof(buffer));
+    check("encode escaped", len == 1 + 2 + 6 + 4 + 1);
+    check("decode escaped", (xbee.decode((const char *)buffer, len) == 1) && (lastLen == 6) && (memcmp(lastFrame, escape, 6) == 0));
+
+    /* Frame split in chunks of one byte with garbage before. */
+    lastLen = 0;
+    xbee.decode("garbage", 7);
+    for (int i = 0; i < len; i++) {
+        xbee.decode((const char *)buffer + i, 1);
+    }
+    check("decode split", (lastLen == 6) && (memcmp(lastFrame, escape, 6) == 0));
+
+    /* Wrong checksum and interrupted frame. */
+    len = xbee.encode(atni, sizeof(atni), buffer, sizeof(buffer));
+    buffer[len - 1] ^= 0x01;
+    check("checksum error", (xbee.decode((const char *)buffer, len) == 0) && (xbee.getChecksumErrors() == 1));
+    xbee.decode((const char *)buffer, 4);
+    len = xbee.encode(atni, sizeof(atni), buffer, sizeof(buffer));
+    check("frame error", (xbee.decode((const char *)buffer, len) == 1) && (xbee.getFrameErrors() == 1));
+    check("buffer too small", xbee.encode(atni, sizeof(atni), buffer, 4) < 0);
+
+    /* Frames sent and received over the UART in loopback. */
+    sc16is7x0_transport_mock mock;
+    gnublin_module_sc16is750 sc16is750;
+    sc16is750.setTransport(&mock);
+    sc16is750.init();
+    sc16is750.enableFifo(1);
+    sc16is750.rxFifoSetTriggerLevel(8);
+    sc16is750.setInterrupt(CONF_INT_RHREN);
+    sc16is750.enableLoopback();
+    xbee.reset();
+    xbee.attach(&sc16is750);
+    check("send", (xbee.send(atni, sizeof(atni)) == 1) && (xbee.send(escape, sizeof(escape)) == 1));
+    while (mock.isIntPending()) {
+        sc16is750.pollInt();
+    }
+    check("uart frames", (xbee.getFrames() == 2) && (lastLen == 6));
+
+    /* No partial frame queued when the TX ring buffer is full. */
+    char filler[TX_BUFFER_SIZE];
+    memset(filler, 0, sizeof(filler));
+    sc16is750.init();
+    sc16is750.enableFifo(1);
+    sc16is750.enableTxBuffer(1);
+    sc16is750.write(filler, sizeof(filler));
+    sc16is750.write(filler, TX_BUFFER_SIZE - sc16is750.txBufferedData() - 4);
+    check("send no room", (xbee.send(atni, sizeof(atni)) < 0) && (sc16is750.txBufferedData() == TX_BUFFER_SIZE - 4));
+    sc16is750.enableTxBuffer(0);
+
+    printf("%d failure(s)\n", failures);
+    return failures;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* test_xbee.c ends here */